@@ -1,47 +1,63 @@
 #include "option_executor.hpp"
-#include <queue>
-#include <unordered_map>
 #include <algorithm>
 #include <cstdlib>
 
 using namespace std;
 
-struct Node{Pos p; double g,h;};
-struct NodeCmp{bool operator()(const Node&a,const Node&b)const{return a.g+a.h>b.g+b.h;}};
-struct PosHash{std::size_t operator()(const Pos&p)const noexcept{return (p.x*73856093) ^ (p.y*19349663);}};
-
 vector<char> OptionExecutor::plan_path(const Env& env, Pos start, Pos goal){
-    auto heuristic = [&](Pos a, Pos b)->double { return static_cast<double>(abs(a.x-b.x) + abs(a.y-b.y)); };
-    priority_queue<Node, std::vector<Node>, NodeCmp> pq;
-    unordered_map<Pos,Pos,PosHash> came;
-    unordered_map<Pos,double,PosHash> gscore;
+    const int W = env.s.W, H = env.s.H;
+    if (W != grid_w || H != grid_h) {
+        grid_w = W; grid_h = H;
+        seen.assign(W*H, 0); closed.assign(W*H, 0);
+        gscore.resize(W*H); came.resize(W*H);
+        query = 0;
+    }
+    if (++query == 0) { // stamps wrapped
+        fill(seen.begin(), seen.end(), 0u); fill(closed.begin(), closed.end(), 0u);
+        query = 1;
+    }
+    for (int b=0;b<3;b++){ open[b].clear(); open_head[b]=0; }
+    expanded = 0;
+    if (!env.inb(start) || !env.inb(goal)) return {};
 
-    pq.push(Node{start,0.0,heuristic(start,goal)});
-    gscore[start]=0;
+    auto heuristic = [&](int c)->int { return abs(c%W - goal.x) + abs(c/W - goal.y); };
+    const int s = env.idx(start), t = env.idx(goal);
+    seen[s] = query; gscore[s] = 0; came[s] = s;
+    int f = heuristic(s);
+    open[f%3].push_back(s);
+    size_t queued = 1;
     static const Pos dirs[4]={{1,0},{-1,0},{0,1},{0,-1}};
 
-    while(!pq.empty()){
-        Node cur = pq.top(); pq.pop();
-        if (cur.p == goal) break;
+    while (queued > 0){
+        int b = f%3;
+        if (open_head[b] == open[b].size()) { open[b].clear(); open_head[b]=0; f++; continue; }
+        int cur = open[b][open_head[b]++]; queued--;
+        if (closed[cur] == query) continue; // stale entry
+        closed[cur] = query;
+        expanded++;
+        if (cur == t) break;
+        Pos cp{cur%W, cur/W};
         for (auto d : dirs){
-            Pos nb{cur.p.x+d.x, cur.p.y+d.y};
+            Pos nb{cp.x+d.x, cp.y+d.y};
             if (!env.inb(nb)) continue;
-            if (env.s.grid[env.idx(nb)] == OBST) continue;
-            double ng = cur.g + 1;
-            if (!gscore.count(nb) || ng < gscore[nb]) {
-                gscore[nb] = ng;
-                pq.push(Node{nb, ng, heuristic(nb,goal)});
-                came[nb] = cur.p;
+            int ni = env.idx(nb);
+            if (env.s.grid[ni] == OBST) continue;
+            int ng = gscore[cur] + 1;
+            if (seen[ni] != query || ng < gscore[ni]) {
+                seen[ni] = query; gscore[ni] = ng; came[ni] = cur;
+                open[(ng + heuristic(ni))%3].push_back(ni);
+                queued++;
             }
         }
     }
 
-    if (!came.count(goal)) return {}; // no path
-    vector<Pos> rev; Pos p = goal; rev.push_back(p);
-    while (p != start) { p = came[p]; rev.push_back(p); }
+    if (closed[t] != query) return {}; // no path
+    rev.clear(); int c = t; rev.push_back(goal);
+    while (c != s) { c = came[c]; rev.push_back(Pos{c%W, c/W}); }
     std::reverse(rev.begin(), rev.end());
 
     vector<char> acts;
+    acts.reserve(rev.size() - 1);
     for (size_t i=1;i<rev.size();i++){
         int dx = rev[i].x - rev[i-1].x;
         int dy = rev[i].y - rev[i-1].y;
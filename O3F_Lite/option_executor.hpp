@@ -6,10 +6,25 @@ using namespace std;
 class OptionExecutor {
     public:
         vector<char> plan_path(const Env&env, Pos start, Pos goal);
+        size_t last_expanded() const { return expanded; } // cells closed by the last plan_path
 
         double run_path(Env& env,const vector<char>& acts) {
             double R=0.0;
             for(char a: acts) R += env.step(a);
             return R;
         }
-};
\ No newline at end of file
+
+    private:
+        // A* scratch kept between plan_path calls; a cell's g/came entries are
+        // valid only when its stamp equals the current query's stamp
+        int grid_w = 0, grid_h = 0;
+        unsigned query = 0;
+        vector<unsigned> seen, closed;
+        vector<int> gscore, came;
+        vector<Pos> rev; // goal-to-start path of the last plan_path
+        // open list: f = g + h only grows by 0 or 2 per step, so 3 FIFO buckets
+        // indexed by f % 3 replace the priority queue
+        vector<int> open[3];
+        size_t open_head[3] = {0, 0, 0};
+        size_t expanded = 0;
+};
@@ -0,0 +1,143 @@
+// Grid scaling benchmark: reset cost, primitive step throughput, option-policy
+// throughput and memory as the grid grows from 32x32 to 2048x2048.
+//
+// Usage: o3f_bench_grid [--max-size N] [--seconds S] [--density D] [--objects N] [--seed N]
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "Env.hpp"
+#include "Option.hpp"
+#include "Rng.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point start) {
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Peak resident set size in KiB (Linux only; 0 elsewhere)
+static long peakRssKiB() {
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.compare(0, 6, "VmHWM:") == 0) return std::stol(line.substr(6));
+	}
+	return 0;
+}
+
+struct ScaleResult {
+	double resetMs = 0.0;
+	double stepsPerSec = 0.0;
+	double policyStepsPerSec = 0.0;
+	std::size_t envBytes = 0;
+	long peakKiB = 0;
+};
+
+static ScaleResult runSize(int size, float density, unsigned int objects, std::uint64_t seed, double budget) {
+	EnvConfig cfg;
+	cfg.gridWidth = size;
+	cfg.gridHeight = size;
+	cfg.obstacleDensity = density;
+	Environment2D env(static_cast<unsigned int>(size * cfg.cellSize), static_cast<unsigned int>(size * cfg.cellSize), cfg);
+	env.setSeed(seed);
+	env.setEpisodeNumber(0);
+
+	ScaleResult r;
+
+	// Reset: at least 3 maps, then as many as fit in the budget
+	int resets = 0;
+	auto start = Clock::now();
+	do {
+		env.reset(objects);
+		++resets;
+	} while (resets < 3 || secondsSince(start) < budget);
+	r.resetMs = secondsSince(start) * 1000.0 / resets;
+
+	// Episodes are capped like the trainer's, which also bounds the undo log
+	const long long episodeSteps = 4LL * (size + size);
+
+	// Primitive steps with uniformly random actions
+	PhiloxEngine rng;
+	rng.seed(seed, 1);
+	long long steps = 0;
+	start = Clock::now();
+	double elapsed = 0.0;
+	double resetTime = 0.0;
+	do {
+		for (long long i = 0; i < episodeSteps; ++i) env.step(static_cast<Action>(rng.uniformInt(0, 3)));
+		steps += episodeSteps;
+		auto resetStart = Clock::now();
+		env.reset(objects);
+		resetTime += secondsSince(resetStart);
+		elapsed = secondsSince(start);
+	} while (elapsed < budget);
+	r.stepsPerSec = steps / (elapsed - resetTime);
+
+	// Scripted option policies: fetch the object (clearing adjacent obstacles
+	// on the way, as the executor does), then carry it to the target
+	auto options = makeDefaultOptions();
+	const Option& fetch = *options[2];
+	const Option& deliver = *options[3];
+	OptionContext ctx;
+	auto fetchPolicy = fetch.policy(ctx);
+	auto deliverPolicy = deliver.policy(ctx);
+	env.reset(objects);
+	steps = 0;
+	long long episodeStep = 0;
+	resetTime = 0.0;
+	start = Clock::now();
+	do {
+		if (env.isTaskComplete() || episodeStep >= episodeSteps) {
+			auto resetStart = Clock::now();
+			env.reset(objects);
+			resetTime += secondsSince(resetStart);
+			episodeStep = 0;
+		}
+		if (!env.isCarrying() && env.hasObstacleNeighbor()) env.clearAnyAdjacentObstacle();
+		env.step(env.isCarrying() ? deliverPolicy(env) : fetchPolicy(env));
+		++steps;
+		++episodeStep;
+		elapsed = secondsSince(start);
+	} while (elapsed < budget);
+	r.policyStepsPerSec = steps / (elapsed - resetTime);
+
+	r.envBytes = env.memoryFootprint();
+	r.peakKiB = peakRssKiB();
+	return r;
+}
+
+int main(int argc, char** argv) {
+	int maxSize = 2048;
+	double budget = 0.5;
+	float density = 0.5f;
+	unsigned int objects = 1;
+	std::uint64_t seed = 1;
+	for (int i = 1; i < argc; ++i) {
+		std::string a = argv[i];
+		if (a == "--max-size" && i + 1 < argc) maxSize = std::stoi(argv[++i]);
+		else if (a == "--seconds" && i + 1 < argc) budget = std::stod(argv[++i]);
+		else if (a == "--density" && i + 1 < argc) density = std::stof(argv[++i]);
+		else if (a == "--objects" && i + 1 < argc) objects = static_cast<unsigned int>(std::stoul(argv[++i]));
+		else if (a == "--seed" && i + 1 < argc) seed = std::stoull(argv[++i]);
+		else {
+			std::cerr << "usage: o3f_bench_grid [--max-size N] [--seconds S] [--density D] [--objects N] [--seed N]" << std::endl;
+			return 1;
+		}
+	}
+
+	std::printf("%-11s %12s %14s %16s %12s %12s\n", "grid", "reset (ms)", "steps/s", "policy steps/s", "env (KiB)", "VmHWM (KiB)");
+	for (int size = 32; size <= maxSize; size *= 2) {
+		ScaleResult r = runSize(size, density, objects, seed, budget);
+		char label[32];
+		std::snprintf(label, sizeof(label), "%dx%d", size, size);
+		std::printf("%-11s %12.3f %14.0f %16.0f %12zu %12ld\n", label, r.resetMs, r.stepsPerSec,
+			r.policyStepsPerSec, r.envBytes / 1024, r.peakKiB);
+		std::fflush(stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,218 @@
+// Pathfinding micro-benchmark: every grid search the options and planners run,
+// over seeded maps at several sizes and obstacle densities. For each search it
+// reports ns/query, cells (or abstract nodes) expanded per query, heap
+// allocations per query and the share of queries that found a path. Queries
+// are random pairs of open interior cells, identical for every search on a map;
+// one untimed pass runs first so buffers sized on first use are not counted.
+// bfsFullPath and bfsNextAction search from the robot, which each query first
+// moves to its start cell (that move is timed too); neither reports cells
+// expanded, so their column shows "-".
+//
+// Usage: o3f_bench_paths [--max-size N] [--seconds S] [--density D] [--queries N] [--seed N]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "DStarLite.hpp"
+#include "Env.hpp"
+#include "HierarchicalPathfinder.hpp"
+#include "Navigation.hpp"
+#include "Pathfinder.hpp"
+#include "Rng.hpp"
+#include "lite_paths.hpp"
+
+// Every heap allocation in the process goes through here, so a search's
+// allocations are the counter's delta across its queries
+static std::atomic<std::size_t> allocations{0};
+
+void* operator new(std::size_t n) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(n ? n : 1)) return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point start) {
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Query {
+	Vec2i start;
+	Vec2i goal;
+};
+
+// One search under test: runs query i, returns whether it found a path and
+// sets `expanded` (-1 when the search does not report it)
+using SearchFn = std::function<bool(const Query&, long long& expanded)>;
+
+struct SearchResult {
+	double nsPerQuery = 0.0;
+	double expandedPerQuery = -1.0;
+	double allocsPerQuery = 0.0;
+	double foundPct = 0.0;
+};
+
+static SearchResult timeSearch(const std::vector<Query>& queries, const SearchFn& search, double budget) {
+	long long expanded = 0;
+	for (const Query& q : queries) search(q, expanded);
+
+	SearchResult r;
+	long long runs = 0;
+	long long found = 0;
+	long long expandedSum = 0;
+	bool reportsExpanded = true;
+	const std::size_t allocStart = allocations.load(std::memory_order_relaxed);
+	const auto start = Clock::now();
+	double elapsed = 0.0;
+	do {
+		for (const Query& q : queries) {
+			expanded = -1;
+			if (search(q, expanded)) ++found;
+			if (expanded < 0) reportsExpanded = false;
+			else expandedSum += expanded;
+		}
+		runs += static_cast<long long>(queries.size());
+		elapsed = secondsSince(start);
+	} while (elapsed < budget);
+	r.allocsPerQuery = static_cast<double>(allocations.load(std::memory_order_relaxed) - allocStart) / runs;
+	r.nsPerQuery = elapsed * 1e9 / runs;
+	if (reportsExpanded) r.expandedPerQuery = static_cast<double>(expandedSum) / runs;
+	r.foundPct = 100.0 * found / runs;
+	return r;
+}
+
+static bool isOpenInterior(const Environment2D& env, const Vec2i& c) {
+	return c.x > 0 && c.y > 0 && c.x < env.getGridWidth() - 1 && c.y < env.getGridHeight() - 1 && !env.isObstacle(c);
+}
+
+static void printRow(const char* grid, float density, const char* search, const SearchResult& r) {
+	char expanded[32];
+	if (r.expandedPerQuery < 0.0) std::snprintf(expanded, sizeof(expanded), "-");
+	else std::snprintf(expanded, sizeof(expanded), "%.0f", r.expandedPerQuery);
+	std::printf("%-11s %7.2f  %-28s %12.0f %12s %10.2f %8.1f\n", grid, density, search, r.nsPerQuery, expanded,
+		r.allocsPerQuery, r.foundPct);
+	std::fflush(stdout);
+}
+
+static void runMap(int size, float density, int queryCount, std::uint64_t seed, double budget) {
+	EnvConfig cfg;
+	cfg.gridWidth = size;
+	cfg.gridHeight = size;
+	cfg.obstacleDensity = density;
+	Environment2D env(static_cast<unsigned int>(size * cfg.cellSize), static_cast<unsigned int>(size * cfg.cellSize), cfg);
+	env.setSeed(seed);
+	env.setEpisodeNumber(0);
+	env.reset(1);
+
+	PhiloxEngine rng;
+	rng.seed(seed, static_cast<std::uint64_t>(size));
+	auto randomOpenCell = [&]() {
+		Vec2i c;
+		do {
+			c = {rng.uniformInt(1, size - 2), rng.uniformInt(1, size - 2)};
+		} while (!isOpenInterior(env, c));
+		return c;
+	};
+	std::vector<Query> queries(static_cast<std::size_t>(queryCount));
+	for (Query& q : queries) q = {randomOpenCell(), randomOpenCell()};
+
+	char grid[32];
+	std::snprintf(grid, sizeof(grid), "%dx%d", size, size);
+
+	Pathfinder flat(cfg.clearCost);
+	HierarchicalPathfinder hierarchy;
+	DStarLite dstar(cfg.clearCost);
+	std::vector<Vec2i> path;
+	ClearingPlan plan;
+
+	const EnvMark generated = env.mark();
+	printRow(grid, density, "bfsFullPath", timeSearch(queries, [&](const Query& q, long long&) {
+		env.placeRobot(q.start);
+		return bfsFullPath(env, q.goal, path);
+	}, budget));
+	printRow(grid, density, "bfsNextAction", timeSearch(queries, [&](const Query& q, long long&) {
+		env.placeRobot(q.start);
+		return bfsNextAction(env, q.goal) != Action::None || q.start == q.goal;
+	}, budget));
+	env.rollback(generated);
+
+	auto flatSearch = [&](PathMode mode, PathAlgorithm algorithm) {
+		return [&flat, &env, &path, mode, algorithm](const Query& q, long long& expanded) {
+			const bool ok = flat.findPath(env, q.start, q.goal, mode, path, algorithm);
+			expanded = static_cast<long long>(flat.lastExpanded());
+			return ok;
+		};
+	};
+	printRow(grid, density, "Pathfinder BFS", timeSearch(queries, flatSearch(PathMode::AvoidObstacles, PathAlgorithm::Bfs), budget));
+	printRow(grid, density, "Pathfinder A*", timeSearch(queries, flatSearch(PathMode::AvoidObstacles, PathAlgorithm::AStar), budget));
+	printRow(grid, density, "Pathfinder BFS ignoring obst", timeSearch(queries, flatSearch(PathMode::IgnoreObstacles, PathAlgorithm::Bfs), budget));
+	printRow(grid, density, "Pathfinder clearing plan", timeSearch(queries, [&](const Query& q, long long& expanded) {
+		const bool ok = flat.findClearingPath(env, q.start, q.goal, plan);
+		expanded = static_cast<long long>(flat.lastExpanded());
+		return ok;
+	}, budget));
+	printRow(grid, density, "D* Lite clearing plan", timeSearch(queries, [&](const Query& q, long long& expanded) {
+		const bool ok = dstar.plan(env, q.start, q.goal);
+		expanded = static_cast<long long>(dstar.lastExpanded());
+		return ok;
+	}, budget));
+	printRow(grid, density, "HPA*", timeSearch(queries, [&](const Query& q, long long& expanded) {
+		const bool ok = hierarchy.findPath(env, q.start, q.goal, path);
+		expanded = static_cast<long long>(hierarchy.lastExpanded());
+		return ok;
+	}, budget));
+
+	// O3F_Lite has no boundary ring of its own, so the boundary is loaded as obstacles
+	std::vector<std::uint8_t> blocked(static_cast<std::size_t>(size) * size);
+	for (int y = 0; y < size; ++y) {
+		for (int x = 0; x < size; ++x) blocked[static_cast<std::size_t>(y) * size + x] = !isOpenInterior(env, {x, y});
+	}
+	liteLoadGrid(size, size, blocked);
+	printRow(grid, density, "O3F_Lite plan_path (A*)", timeSearch(queries, [&](const Query& q, long long& expanded) {
+		std::size_t closed = 0;
+		const bool ok = litePlanPath(q.start.x, q.start.y, q.goal.x, q.goal.y, closed) > 0 || q.start == q.goal;
+		expanded = static_cast<long long>(closed);
+		return ok;
+	}, budget));
+}
+
+int main(int argc, char** argv) {
+	int maxSize = 512;
+	double budget = 0.2;
+	float onlyDensity = -1.0f;
+	int queryCount = 64;
+	std::uint64_t seed = 1;
+	for (int i = 1; i < argc; ++i) {
+		std::string a = argv[i];
+		if (a == "--max-size" && i + 1 < argc) maxSize = std::stoi(argv[++i]);
+		else if (a == "--seconds" && i + 1 < argc) budget = std::stod(argv[++i]);
+		else if (a == "--density" && i + 1 < argc) onlyDensity = std::stof(argv[++i]);
+		else if (a == "--queries" && i + 1 < argc) queryCount = std::stoi(argv[++i]);
+		else if (a == "--seed" && i + 1 < argc) seed = std::stoull(argv[++i]);
+		else {
+			std::cerr << "usage: o3f_bench_paths [--max-size N] [--seconds S] [--density D] [--queries N] [--seed N]" << std::endl;
+			return 1;
+		}
+	}
+	if (queryCount < 1) queryCount = 1;
+
+	std::vector<float> densities = {0.1f, 0.3f, 0.5f};
+	if (onlyDensity >= 0.0f) densities = {onlyDensity};
+
+	std::printf("%-11s %7s  %-28s %12s %12s %10s %8s\n", "grid", "density", "search", "ns/query", "expanded", "allocs/q",
+		"found %");
+	for (int size = 32; size <= maxSize; size *= 2) {
+		for (float density : densities) runMap(size, density, queryCount, seed, budget);
+	}
+	return 0;
+}
@@ -0,0 +1,126 @@
+// Q-table contention benchmark: worker threads applying one-step Q-learning
+// backups to a shared table in each ConcurrentQTable mode, against the plain
+// single-threaded QTable as a baseline. Transitions are drawn per thread from
+// a seeded stream; --hot narrows them to that many states so workers collide
+// on the same rows. Reports total backups per second and ns per backup on
+// each thread.
+//
+// Usage: o3f_bench_qtable [--threads N] [--updates N] [--states N] [--actions N] [--hot N] [--merge N] [--seed N]
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentQTable.hpp"
+#include "QTable.hpp"
+#include "Rng.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct Workload {
+	int states = 144;
+	int actions = 6;
+	int hot = 0;           // 0 = every state
+	long long updates = 2000000; // per thread
+	int mergeInterval = 64;
+	std::uint64_t seed = 1;
+};
+
+struct Transition {
+	int state;
+	int action;
+	float reward;
+	int next;
+};
+
+static constexpr float kAlpha = 0.1f;
+static constexpr float kGamma = 0.95f;
+
+// A fixed batch per thread, generated before timing so the RNG is not measured
+static std::vector<Transition> makeTransitions(const Workload& w, std::uint64_t stream) {
+	PhiloxEngine rng;
+	rng.seed(w.seed, stream);
+	const int last = (w.hot > 0 && w.hot < w.states ? w.hot : w.states) - 1;
+	std::vector<Transition> t(4096);
+	for (Transition& x : t) {
+		x.state = rng.uniformInt(0, last);
+		x.action = rng.uniformInt(0, w.actions - 1);
+		x.reward = rng.uniformInt(-10, 10) * 0.1f;
+		x.next = rng.uniformInt(0, last);
+	}
+	return t;
+}
+
+static void printRow(const char* mode, int threads, double seconds, long long total) {
+	std::printf("%-14s %7d %14.2f %12.1f\n", mode, threads, total / seconds / 1e6, seconds * 1e9 / total * threads);
+	std::fflush(stdout);
+}
+
+static void runPlain(const Workload& w) {
+	QTable table(w.states, w.actions);
+	const std::vector<Transition> batch = makeTransitions(w, 0);
+	const auto start = Clock::now();
+	for (long long i = 0; i < w.updates; ++i) {
+		const Transition& x = batch[static_cast<std::size_t>(i) & (batch.size() - 1)];
+		float& q = table.at(x.state, x.action);
+		q += kAlpha * (x.reward + kGamma * table.maxValue(x.next) - q);
+	}
+	printRow("QTable", 1, std::chrono::duration<double>(Clock::now() - start).count(), w.updates);
+}
+
+static void runShared(const Workload& w, QConcurrency mode, const char* name, int threads) {
+	ConcurrentQTable table(w.states, w.actions, mode, w.mergeInterval);
+	std::vector<std::vector<Transition>> batches;
+	for (int t = 0; t < threads; ++t) batches.push_back(makeTransitions(w, static_cast<std::uint64_t>(t)));
+	std::vector<std::thread> workers;
+	const auto start = Clock::now();
+	for (int t = 0; t < threads; ++t) {
+		workers.emplace_back([&table, &w, &batch = batches[static_cast<std::size_t>(t)]]() {
+			for (long long i = 0; i < w.updates; ++i) {
+				const Transition& x = batch[static_cast<std::size_t>(i) & (batch.size() - 1)];
+				table.backup(x.state, x.action, x.reward, x.next, kAlpha, kGamma);
+			}
+		});
+	}
+	for (std::thread& th : workers) th.join();
+	table.flush();
+	printRow(name, threads, std::chrono::duration<double>(Clock::now() - start).count(), w.updates * threads);
+}
+
+int main(int argc, char** argv) {
+	Workload w;
+	int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+	if (maxThreads < 4) maxThreads = 4;
+	for (int i = 1; i < argc; ++i) {
+		std::string a = argv[i];
+		if (a == "--threads" && i + 1 < argc) maxThreads = std::stoi(argv[++i]);
+		else if (a == "--updates" && i + 1 < argc) w.updates = std::stoll(argv[++i]);
+		else if (a == "--states" && i + 1 < argc) w.states = std::stoi(argv[++i]);
+		else if (a == "--actions" && i + 1 < argc) w.actions = std::stoi(argv[++i]);
+		else if (a == "--hot" && i + 1 < argc) w.hot = std::stoi(argv[++i]);
+		else if (a == "--merge" && i + 1 < argc) w.mergeInterval = std::stoi(argv[++i]);
+		else if (a == "--seed" && i + 1 < argc) w.seed = std::stoull(argv[++i]);
+		else {
+			std::cerr << "usage: o3f_bench_qtable [--threads N] [--updates N] [--states N] [--actions N] [--hot N] [--merge N] [--seed N]" << std::endl;
+			return 1;
+		}
+	}
+	if (maxThreads < 1) maxThreads = 1;
+	if (w.states < 1) w.states = 1;
+	if (w.actions < 1) w.actions = 1;
+
+	std::printf("%d states x %d actions, %s, %lld backups per thread, %u hardware threads\n", w.states, w.actions,
+		w.hot > 0 ? (std::to_string(w.hot) + " hot states").c_str() : "uniform states", w.updates,
+		std::thread::hardware_concurrency());
+	std::printf("%-14s %7s %14s %12s\n", "mode", "threads", "Mbackups/s", "ns/backup");
+	runPlain(w);
+	for (int threads = 1; threads <= maxThreads; threads *= 2) {
+		runShared(w, QConcurrency::Hogwild, "Hogwild", threads);
+		runShared(w, QConcurrency::ShardedLocks, "ShardedLocks", threads);
+		runShared(w, QConcurrency::ThreadDeltas, "ThreadDeltas", threads);
+	}
+	return 0;
+}
@@ -0,0 +1,23 @@
+#include "lite_paths.hpp"
+
+#include "../O3F_Lite/env.hpp"
+#include "../O3F_Lite/option_executor.hpp"
+
+static Env liteEnv;
+static OptionExecutor liteExec;
+
+void liteLoadGrid(int w, int h, const std::vector<std::uint8_t>& blocked) {
+	liteEnv.s = {};
+	liteEnv.s.W = w;
+	liteEnv.s.H = h;
+	liteEnv.s.grid.assign(static_cast<std::size_t>(w) * h, EMPTY);
+	for (std::size_t i = 0; i < liteEnv.s.grid.size(); ++i) {
+		if (blocked[i]) liteEnv.s.grid[i] = OBST;
+	}
+}
+
+std::size_t litePlanPath(int sx, int sy, int gx, int gy, std::size_t& expanded) {
+	const std::size_t moves = liteExec.plan_path(liteEnv, Pos{sx, sy}, Pos{gx, gy}).size();
+	expanded = liteExec.last_expanded();
+	return moves;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bridge to the standalone O3F_Lite trainer's A* (OptionExecutor::plan_path).
+// O3F_Lite's headers pull `using namespace std` and short global names (Cell,
+// Pos, State), so they stay confined to lite_paths.cpp.
+
+// Load a w x h grid into the O3F_Lite environment; blocked[y * w + x] != 0 marks an obstacle
+void liteLoadGrid(int w, int h, const std::vector<std::uint8_t>& blocked);
+// Plan from (sx, sy) to (gx, gy); returns the number of moves (0 when
+// unreachable or start == goal) and the cells the search closed
+std::size_t litePlanPath(int sx, int sy, int gx, int gy, std::size_t& expanded);
@@ -5,6 +5,7 @@
 
 class Environment2D;
 class Option;
+struct OptionContext;
 class OptionPlanner;
 class OptionExecutor;
 class Visualizer;
@@ -27,6 +28,7 @@ private:
 	std::unique_ptr<OptionPlanner> planner;
 	std::unique_ptr<OptionExecutor> executor;
 	std::vector<std::unique_ptr<Option>> options;
+	std::unique_ptr<OptionContext> context;
 
 	int currentOptionIdx;
 	float timeSinceSelect;
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CoreTypes.hpp"
+#include "Env.hpp"
+
+// N grid environments stepped together in struct-of-arrays layout.
+// Robot/target/object cells live in contiguous per-field arrays, the carrying
+// flags in a bitmask and all grids in one packed slab, so a batch step is a
+// few linear sweeps instead of N calls into Environment2D. The grid slab only
+// holds static content (empty/obstacle/object/target); robots are tracked in
+// the coordinate arrays.
+class BatchEnvironment2D {
+public:
+	BatchEnvironment2D(std::size_t count, int gridW, int gridH);
+
+	// Copy the grid state of a single environment into slot i.
+	// The environment must have the batch's grid dimensions and a single object.
+	void load(std::size_t i, const Environment2D& env);
+
+	// Advance every environment by one primitive action; same move, clamp,
+	// collision, pickup and reward rules as Environment2D::step(Action).
+	// `actions` and `rewards` must both hold size() entries.
+	void step(const Action* actions, float* rewards);
+
+	std::size_t size() const { return count; }
+	int getGridWidth() const { return gridW; }
+	int getGridHeight() const { return gridH; }
+	Vec2i getRobotCell(std::size_t i) const { return {robotX[i], robotY[i]}; }
+	Vec2i getTargetCell(std::size_t i) const { return {targetX[i], targetY[i]}; }
+	Vec2i getObjectCell(std::size_t i) const { return {objectX[i], objectY[i]}; }
+	bool isCarrying(std::size_t i) const { return (carryingBits[i >> 6] >> (i & 63)) & 1u; }
+	bool isTaskComplete(std::size_t i) const { return isCarrying(i) && getRobotCell(i) == getTargetCell(i); }
+	CellType cellAt(std::size_t i, int x, int y) const {
+		return static_cast<CellType>(grid[i * cellsPerEnv + static_cast<std::size_t>(y * gridW + x)]);
+	}
+
+private:
+	std::size_t count;
+	int gridW;
+	int gridH;
+	std::size_t cellsPerEnv;
+
+	std::vector<std::int32_t> robotX;
+	std::vector<std::int32_t> robotY;
+	std::vector<std::int32_t> targetX;
+	std::vector<std::int32_t> targetY;
+	std::vector<std::int32_t> objectX;
+	std::vector<std::int32_t> objectY;
+	std::vector<std::uint64_t> carryingBits;
+	// count * cellsPerEnv CellType bytes (+ tail padding for 32-bit gathers)
+	std::vector<std::uint8_t> grid;
+	// count * cellsPerEnv path distances to each target, copied from the
+	// environment's distance field (the batch never clears obstacles)
+	std::vector<std::int32_t> targetDist;
+
+	void stepScalar(std::size_t begin, std::size_t end, const Action* actions, float* rewards);
+	void setCarrying(std::size_t i) { carryingBits[i >> 6] |= std::uint64_t(1) << (i & 63); }
+};
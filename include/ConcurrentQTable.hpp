@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class QTable;
+
+// How a ConcurrentQTable lets several worker threads update it
+enum class QConcurrency : std::uint8_t {
+	None,        // single writer: OptionPlanner keeps using its plain QTable
+	Hogwild,     // lock-free relaxed loads and stores; concurrent updates of one entry may be lost
+	ShardedLocks,// a mutex per shard of states serializes each read-modify-write
+	ThreadDeltas // each thread accumulates into a private delta, merged into the shared table every mergeInterval updates
+};
+
+// Q-table shared by worker threads. Values are relaxed atomics, so reads are
+// always race-free; the mode decides how a backup writes. The shape is fixed
+// at construction, since rows cannot grow while other threads read them.
+class ConcurrentQTable {
+public:
+	ConcurrentQTable(int numStates, int numActions, QConcurrency mode, int mergeInterval = 64);
+	~ConcurrentQTable();
+	ConcurrentQTable(const ConcurrentQTable&) = delete;
+	ConcurrentQTable& operator=(const ConcurrentQTable&) = delete;
+
+	QConcurrency mode() const { return concurrency; }
+	int numStates() const { return states; }
+	int numActions() const { return actions; }
+
+	// Greedy option and best value of a state, including the calling thread's
+	// unmerged delta in ThreadDeltas mode
+	int argmax(int state);
+	float maxValue(int state);
+	// Q(s, a) += alpha * (reward + discount * max Q(next) - Q(s, a)); returns the TD error;
+	// discount is gamma^k for an option that ran k steps
+	float backup(int state, int action, float reward, int next, float alpha, float discount);
+	void touch(int state) { touchedRows[state].store(1, std::memory_order_relaxed); }
+
+	// Merge every thread's pending delta (ThreadDeltas); call while workers are quiescent
+	void flush();
+	// Copy values and touched flags out of / into a plain table (workers quiescent)
+	void snapshot(QTable& out);
+	void load(const QTable& in);
+
+private:
+	// One thread's unmerged updates: a full-size delta table plus the entries
+	// written since the last merge, so merging costs O(mergeInterval)
+	struct Delta {
+		std::vector<float> values;
+		std::vector<std::uint32_t> dirty;
+	};
+	static constexpr std::size_t kShards = 64;
+	struct alignas(64) Shard {
+		std::mutex mutex;
+	};
+
+	int states;
+	int actions;
+	QConcurrency concurrency;
+	int mergeEvery;
+	std::uint64_t instance; // identifies this table to the thread-local delta cache
+	std::unique_ptr<std::atomic<float>[]> values;
+	std::unique_ptr<std::atomic<std::uint8_t>[]> touchedRows;
+	std::unique_ptr<Shard[]> shards;
+	std::mutex deltaMutex; // guards delta registration and every write to the shared values in ThreadDeltas
+	std::vector<std::unique_ptr<Delta>> deltas;
+	std::vector<std::thread::id> deltaOwners;
+
+	std::atomic<float>& at(int state, int action) { return values[static_cast<std::size_t>(state) * actions + action]; }
+	float get(int state, int action) { return at(state, action).load(std::memory_order_relaxed); }
+	float sharedMax(int state);
+	// The calling thread's delta (ThreadDeltas), registered on first use
+	Delta& localDelta();
+	void merge(Delta& d);
+};
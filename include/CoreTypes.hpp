@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// Plain value types used by the headless core (environment, options, planner).
+// They carry no graphics dependency; the SFML layer converts at the boundary.
+template <typename T>
+struct Vec2 {
+	T x;
+	T y;
+
+	constexpr Vec2() : x(0), y(0) {}
+	constexpr Vec2(T x_, T y_) : x(x_), y(y_) {}
+
+	constexpr bool operator==(const Vec2& o) const { return x == o.x && y == o.y; }
+	constexpr bool operator!=(const Vec2& o) const { return !(*this == o); }
+	constexpr Vec2 operator+(const Vec2& o) const { return {x + o.x, y + o.y}; }
+	constexpr Vec2 operator-(const Vec2& o) const { return {x - o.x, y - o.y}; }
+	constexpr Vec2 operator*(T s) const { return {x * s, y * s}; }
+	Vec2& operator+=(const Vec2& o) { x += o.x; y += o.y; return *this; }
+	Vec2& operator-=(const Vec2& o) { x -= o.x; y -= o.y; return *this; }
+};
+
+using Vec2i = Vec2<int>;
+using Vec2f = Vec2<float>;
+
+struct Color {
+	std::uint8_t r = 0;
+	std::uint8_t g = 0;
+	std::uint8_t b = 0;
+	std::uint8_t a = 255;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "CoreTypes.hpp"
+#include "Pathfinder.hpp"
+
+class Environment2D;
+
+// Incremental minimum clearing-cost planner (D* Lite, Koenig & Likhachev 2002)
+// over the same cost model as Pathfinder's ObstacleCost mode: entering a cell
+// costs 1, plus obstacleCost if it holds an obstacle; boundary cells are never
+// entered.
+//
+// The search runs backward from the goal, so the robot may move freely between
+// queries. Grid edits are read from the environment's change log
+// (Environment2D::cellChanges): each query replays the entries appended since
+// the previous one and re-expands only the cells whose cost-to-goal they
+// affect, so clearing one obstacle costs roughly the changed region instead of
+// a whole new search. A new goal, grid size, cost or log epoch (reset,
+// rollback) starts a fresh search.
+class DStarLite {
+public:
+	explicit DStarLite(int obstacleCost = 2) : clearCost(obstacleCost) {}
+
+	// Bring the search up to date for env's current grid and compute the
+	// minimum cost from start to goal. False when goal is unreachable.
+	bool plan(const Environment2D& env, const Vec2i& start, const Vec2i& goal);
+	// After a successful plan(): the first move from start, or the whole path
+	// (start excluded) and the obstacles it clears
+	bool nextCell(Vec2i& out) const;
+	void extractPath(ClearingPlan& out) const;
+
+	// Cost of the last successful plan (steps plus clearing costs)
+	int lastCost() const { return startCost; }
+	// Cells expanded by the last plan() call
+	std::size_t lastExpanded() const { return expanded; }
+	int obstacleCost() const { return clearCost; }
+	void setObstacleCost(int c);
+	// Forget the search; the next plan() starts from scratch
+	void invalidate() { goalIndex = -1; }
+	std::size_t sizeBytes() const;
+
+private:
+	static constexpr std::int32_t kInf = std::numeric_limits<std::int32_t>::max() / 4;
+	struct Key {
+		std::int32_t k1;
+		std::int32_t k2;
+		bool operator<(const Key& o) const { return k1 < o.k1 || (k1 == o.k1 && k2 < o.k2); }
+		bool operator==(const Key& o) const { return k1 == o.k1 && k2 == o.k2; }
+	};
+	struct HeapEntry {
+		Key key;
+		std::int32_t cell;
+	};
+
+	int clearCost;
+	int w = 0;
+	int h = 0;
+	int goalIndex = -1;
+	int startIndex = -1;
+	int lastStart = -1; // start at the last repair, for the key modifier
+	std::int32_t km = 0;
+	std::uint64_t epoch = 0;
+	std::size_t logPos = 0; // change-log entries already applied
+	std::vector<std::int32_t> g;
+	std::vector<std::int32_t> rhs;
+	std::vector<std::uint8_t> blocked; // obstacle state the search was built on
+	// lazy-deletion binary heap: an entry is live while its cell is open with the same key
+	std::vector<HeapEntry> heap;
+	std::vector<Key> openKey;
+	std::vector<std::uint8_t> open;
+	int startCost = 0;
+	std::size_t expanded = 0;
+
+	void restart(const Environment2D& env, int goal);
+	void applyChanges(const Environment2D& env);
+	void computeShortestPath();
+	void updateVertex(int u);
+	void updatePredecessors(int u);
+	Key calculateKey(int u) const;
+	int heuristic(int a, int b) const;
+	bool enterable(int u) const;
+	std::int32_t enterCost(int u) const { return 1 + (blocked[u] ? clearCost : 0); }
+	int bestSuccessor(int u) const;
+	// min-heap order for the std heap algorithms
+	static bool heapAfter(const HeapEntry& a, const HeapEntry& b);
+	void push(int u, const Key& k);
+	bool topLive();
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "CoreTypes.hpp"
+#include "ObstacleBitboard.hpp"
+
+// Shortest-path distance (4-connected, unit cost) from a set of source cells to
+// every cell, computed by reverse BFS. Like the option searches, only interior
+// non-obstacle cells are traversable; boundary cells and obstacles read as
+// unreachable. After a full build(), clearing an obstacle only ever shortens
+// distances, so cellCleared() repairs the field by propagating from the cleared
+// cell instead of rebuilding it.
+//
+// build() runs a bit-parallel wavefront: passable cells, visited cells and the
+// frontier are bit rows (64 cells per word), and one BFS level is a few shifts,
+// ORs and ANDs per word over the rows the frontier can reach (four words per
+// instruction with AVX2). Only the distance writes touch cells one at a time.
+class DistanceField {
+public:
+	static constexpr std::int32_t kUnreachable = std::numeric_limits<std::int32_t>::max();
+
+	void build(const ObstacleBitboard& obstacles, int width, int height, const std::vector<Vec2i>& sources);
+	void cellCleared(const ObstacleBitboard& obstacles, const Vec2i& cell);
+	// Forget all distances (e.g. when the source disappears)
+	void invalidate();
+
+	bool valid() const { return !dist.empty(); }
+	std::int32_t at(const Vec2i& c) const {
+		if (dist.empty() || c.x < 0 || c.x >= w || c.y < 0 || c.y >= h) return kUnreachable;
+		return dist[c.y * w + c.x];
+	}
+	std::int32_t at(int index) const { return dist.empty() ? kUnreachable : dist[index]; }
+	std::size_t sizeBytes() const {
+		return (dist.capacity() + queue.capacity()) * sizeof(std::int32_t) +
+			(passableBits.capacity() + visitedBits.capacity() + frontierBits.capacity() + nextBits.capacity()) * sizeof(std::uint64_t);
+	}
+
+private:
+	int w = 0;
+	int h = 0;
+	std::vector<std::int32_t> dist;
+	std::vector<int> queue; // reused between repairs
+	// Wavefront bit rows, `stride` words per row: one zero word on the left, the
+	// row's cells, then zero words up to a multiple of four plus one on the right,
+	// so neighbor-word and 4-word loads never leave the row
+	int stride = 0;
+	std::vector<std::uint64_t> passableBits;
+	std::vector<std::uint64_t> visitedBits;
+	std::vector<std::uint64_t> frontierBits;
+	std::vector<std::uint64_t> nextBits;
+	// Per row, bit k set when word k of the frontier (next) row is non-zero, and
+	// the neighboring words its edge bits spill into, so a level only visits
+	// words the frontier can reach. Rows wider than 64 words just use bit 0 for
+	// "row non-zero" and are swept whole.
+	std::vector<std::uint64_t> frontierWords;
+	std::vector<std::uint64_t> nextWords;
+	std::vector<std::uint64_t> frontierSpill;
+	std::vector<std::uint64_t> nextSpill;
+
+	bool passable(const ObstacleBitboard& obstacles, int x, int y) const {
+		return x > 0 && x < w - 1 && y > 0 && y < h - 1 && !obstacles.test(x, y);
+	}
+	void propagate(const ObstacleBitboard& obstacles, std::size_t head);
+	// Expand the frontier in rows [lo, hi] by one level into nextBits, writing
+	// `level` for every newly reached cell and widening [nextLo, nextHi] to the
+	// rows reached
+	void expandLevel(int lo, int hi, int wordsPerRow, std::int32_t level, int& nextLo, int& nextHi);
+};
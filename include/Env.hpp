@@ -1,101 +1,250 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <functional>
-#include <SFML/Graphics.hpp>
+#include "CoreTypes.hpp"
+#include "DStarLite.hpp"
+#include "DistanceField.hpp"
+#include "HierarchicalPathfinder.hpp"
+#include "ObjectIndex.hpp"
+#include "ObstacleBitboard.hpp"
+#include "Rng.hpp"
+#include "utils.h"
 
-enum class CellType { Empty, Obstacle, Object, Target, Robot };
+class ScenarioCorpus;
+
+enum class CellType : std::uint8_t { Empty, Obstacle, Object, Target, Robot };
 
 enum class Action { Up, Down, Left, Right, None };
 
 struct Object2D {
 	float radius;
-	sf::Vector2f position;
-	sf::Color color;
+	Vec2f position;
+	Color color;
 };
 
 struct Robot2D {
 	float radius;
-	sf::Vector2f position;
-	sf::Vector2f velocity;
+	Vec2f position;
+	Vec2f velocity;
 	float maxSpeed;
 };
 
+// Runtime map configuration; utils.h holds the defaults
+struct EnvConfig {
+	int gridWidth = GRID_WIDTH;      // clamped to at least MIN_GRID_WIDTH
+	int gridHeight = GRID_HEIGHT;    // clamped to at least MIN_GRID_HEIGHT
+	float obstacleDensity = 0.5f;    // obstacle placement attempts per cell (repeats collapse)
+	float cellSize = CELL_SIZE;      // pixels per cell for the continuous/visual space
+	int clearCost = 2;               // extra steps charged per obstacle by clearing-path planning
+};
+
+// Compact capture of the fields the planner's state abstraction reads.
+// Taking one per option replaces copying the whole environment.
+struct StateKey {
+	Vec2i robotCell;
+	Vec2i targetCell;
+	Vec2i objectCell;
+	bool carrying = false;
+	bool obstacleNeighbor = false;
+};
+
+// One grid write recorded in the environment's undo log
+struct CellChange {
+	int index;
+	CellType before;
+	CellType after;
+};
+
+// Position in the undo log plus the scalar state needed to restore it.
+// Only valid until the next reset().
+struct EnvMark {
+	std::size_t logSize = 0;
+	std::uint64_t resetCount = 0;
+	std::size_t objectLogSize = 0;
+	Vec2i robotCell;
+	Vec2i objectCell;
+	bool carrying = false;
+};
+
 class Environment2D {
 public:
-	Environment2D(unsigned int width, unsigned int height);
+	Environment2D(unsigned int width, unsigned int height, const EnvConfig& cfg = EnvConfig());
 
+	// Generate a new map with numObjects objects (at least one)
 	void reset(unsigned int numObjects);
-	// Allow external code to inform environment which episode is running
-	void setEpisodeNumber(int ep) { currentEpisode = ep; }
+	// Replay stored maps instead of generating them. The corpus must outlive
+	// the environment and match its grid size (returns false otherwise).
+	bool attachScenarios(const ScenarioCorpus* corpus);
+	// Load scenario i of the attached corpus; false if it is missing or invalid
+	bool resetFromScenario(std::size_t i);
+	// Allow external code to inform environment which episode is running. Also
+	// restarts the reset index, so call it once per episode: further reset()s
+	// in the same episode generate fresh maps at the following indices.
+	void setEpisodeNumber(int ep) { currentEpisode = ep; resetsInEpisode = 0; }
+	// Map generation is a pure function of (seed, episode number, reset index
+	// within the episode). The default seed is drawn once at construction.
+	void setSeed(std::uint64_t seed) { rngSeed = seed; }
+	std::uint64_t getSeed() const { return rngSeed; }
 	// grid step using primitive action, returns reward
 	float step(Action action);
 	// continuous physics step for legacy behavior
 	void step(float dt);
 
 	// Simple physics-lite interactions
-	void setRobotTarget(const sf::Vector2f& target);
+	void setRobotTarget(const Vec2f& target);
+	// Move the robot straight to an open cell, without picking anything up.
+	// Logged like a step, so rollback() undoes it. False (and no move) for
+	// cells outside the map or holding an obstacle.
+	bool placeRobot(const Vec2i& cell);
 
 	// Accessors
 	const Robot2D& getRobot() const { return robot; }
 	const std::vector<Object2D>& getObjects() const { return objects; }
 	unsigned int getWidth() const { return width; }
 	unsigned int getHeight() const { return height; }
-	const sf::Vector2f& getTargetRegion() const { return targetRegion; }
+	const Vec2f& getTargetRegion() const { return targetRegion; }
 	float getTargetRadius() const { return targetRadius; }
 
 	// Grid accessors
+	const EnvConfig& getConfig() const { return config; }
+	float getCellSize() const { return config.cellSize; }
 	int getGridWidth() const { return gridW; }
 	int getGridHeight() const { return gridH; }
-	sf::Vector2i getRobotCell() const { return robotCell; }
-	sf::Vector2i getTargetCell() const { return targetCell; }
+	Vec2i getRobotCell() const { return robotCell; }
+	Vec2i getTargetCell() const { return targetCell; }
 	const std::vector<CellType>& getGrid() const { return grid; }
+	const ObstacleBitboard& getObstacles() const { return obstacles; }
 
 	// Obstacle helpers
 	bool hasObstacleNeighbor() const;
 	bool clearAnyAdjacentObstacle();
-	bool isObstacle(const sf::Vector2i& cell) const;
+	bool isObstacle(const Vec2i& cell) const;
 
 	// Drop carried object one cell to the left (or nearest adjacent empty cell)
 	// Returns true if the object was dropped.
 	bool dropObjectLeft();
 
-	// Object / carrying helpers
-	sf::Vector2i getObjectCell() const { return objectCell; }
+	// Object / carrying helpers. The object cell is the nearest uncarried
+	// object to the robot, or where the carried object was picked up.
+	Vec2i getObjectCell() const { return objectCell; }
 	bool isCarrying() const { return carrying; }
+	// Uncarried objects on the map, in no particular order
+	std::size_t objectCount() const { return objectIndex.size(); }
+	const std::vector<Vec2i>& getObjectCells() const { return objectIndex.items(); }
+	bool nearestObject(const Vec2i& from, Vec2i& out) const { return objectIndex.nearest(from, out); }
+
+	// True shortest-path distances (interior cells, obstacles blocking) to the
+	// target and to the nearest uncarried object, maintained across reset, obstacle
+	// clears and drops. DistanceField::kUnreachable when there is no path.
+	std::int32_t distanceToTarget(const Vec2i& cell) const { return targetField.at(cell); }
+	std::int32_t distanceToObject(const Vec2i& cell) const { return objectField.at(cell); }
 	
 	// A* heuristic methods
-	float computeHeuristicCost(const sf::Vector2i& from, const sf::Vector2i& to) const;
-	bool shouldClearObstacle(const sf::Vector2i& obstaclePos) const;
-	// Check if clearing the obstacle at obstaclePos is beneficial when heading toward `dest`
-	bool shouldClearObstacleToward(const sf::Vector2i& obstaclePos, const sf::Vector2i& dest) const;
+	float computeHeuristicCost(const Vec2i& from, const Vec2i& to) const;
+	// True if obstaclePos is among the obstacles cleared by the minimum
+	// clearing-cost path from the robot to the target (or to `dest`)
+	bool shouldClearObstacle(const Vec2i& obstaclePos) const;
+	bool shouldClearObstacleToward(const Vec2i& obstaclePos, const Vec2i& dest) const;
+
+	// Path from the robot to dest minimizing steps + clearCost * obstacles
+	// cleared, with the exact obstacles it clears
+	bool planClearingPath(const Vec2i& dest, ClearingPlan& plan) const;
+	// Next cell of that path. The search persists between calls and is repaired
+	// from the change log, so following it while obstacles are cleared does not
+	// replan from scratch. False at dest or when dest is unreachable.
+	bool nextPlannedCell(const Vec2i& dest, Vec2i& next) const;
+	// The next planned cell toward dest is an obstacle the robot may clear now
+	bool hasPlannedClear(const Vec2i& dest) const;
+	bool clearPlannedObstacle(const Vec2i& dest);
+	// Near-shortest obstacle-avoiding path over the cluster hierarchy (HPA*),
+	// built on first use and repaired per cluster as obstacles change. Meant for
+	// large maps, where its cost tracks path length instead of map area.
+	bool findHierarchicalPath(const Vec2i& start, const Vec2i& goal, std::vector<Vec2i>& out) const {
+		return hierarchy.findPath(*this, start, goal, out);
+	}
+	// Clear the obstacle at cell if it is adjacent to the robot (not while carrying)
+	bool clearObstacleAt(const Vec2i& cell);
 	
 	// Task completion check: require carrying the object and being at the target
 	bool isTaskComplete() const { return carrying && robotCell == targetCell; }
 
-	// Rendering
-	void render(sf::RenderWindow& window);
+	// Bumped by every write that changes obstacles or objects (including
+	// reset and rollback), never by robot or target marker moves. Searches that
+	// only read those cells can reuse results while it is unchanged.
+	std::uint64_t getGeneration() const { return generation; }
+
+	// Grid writes since the last reset, oldest first (the undo log). Incremental
+	// planners replay the entries they have not seen; changeEpoch() moves on
+	// every reset and rollback, after which they must start over.
+	const std::vector<CellChange>& cellChanges() const { return undoLog; }
+	std::uint64_t changeEpoch() const { return logEpoch; }
+
+	// Lightweight snapshot of the planner-relevant state
+	StateKey stateKey() const;
+
+	// Bytes held by per-cell structures (grid, bitboard, distance fields, undo log, planners)
+	std::size_t memoryFootprint() const;
+
+	// Transactional snapshots backed by an undo log of cell writes:
+	// mark() is O(1), rollback() undoes only the cells written since the mark,
+	// diff() lists the net cell changes since the mark, one entry per cell in
+	// index order, in O(k log k) for k logged writes.
+	EnvMark mark() const;
+	void rollback(const EnvMark& m);
+	std::vector<CellChange> diff(const EnvMark& m) const;
 
 private:
+	EnvConfig config;
 	unsigned int width;
 	unsigned int height;
 	Robot2D robot;
 	std::vector<Object2D> objects;
-	sf::Vector2f robotTarget;
-	sf::Vector2f targetRegion;
+	Vec2f robotTarget;
+	Vec2f targetRegion;
 	float targetRadius;
 
 	// Grid representation
 	int gridW;
 	int gridH;
 	std::vector<CellType> grid;
-	sf::Vector2i robotCell;
-	sf::Vector2i targetCell;
-	sf::Vector2i objectCell;
+	// Bit-packed mirror of the Obstacle cells in `grid`, kept in sync by setCell()
+	ObstacleBitboard obstacles;
+	Vec2i robotCell;
+	Vec2i targetCell;
+	Vec2i objectCell;
 	bool carrying = false;
 	int currentEpisode = 0;
-
-	void resolveBoundaries(sf::Vector2f& pos, float radius);
-	float computeReward(const sf::Vector2i& prevRobotCell) const;
+	int resetsInEpisode = 0;
+	std::uint64_t rngSeed = 0;
+	PhiloxEngine rng;
+	// Cell writes since the last reset, oldest first
+	std::vector<CellChange> undoLog;
+	std::uint64_t resetCount = 0;
+	std::uint64_t generation = 0;
+	std::uint64_t logEpoch = 0;
+	// Uncarried objects, and pickups (added=false) / drops since the last reset
+	ObjectIndex objectIndex;
+	struct ObjectChange { Vec2i cell; bool added; };
+	std::vector<ObjectChange> objectLog;
+	// Distance fields toward the target and the uncarried objects
+	DistanceField targetField;
+	DistanceField objectField;
+	const ScenarioCorpus* scenarios = nullptr;
+	// Clearing-path planning state; mutable so const queries can repair and reuse it
+	mutable DStarLite planner;
+	mutable ClearingPlan clearingPlan;
+	mutable HierarchicalPathfinder hierarchy;
+
+	void resolveBoundaries(Vec2f& pos, float radius);
+	float computeReward(const Vec2i& prevRobotCell) const;
 	int idx(int x, int y) const { return y * gridW + x; }
+	void setCell(const Vec2i& c, CellType t);
+	void writeCell(int i, CellType t);
+	void syncRobotPosition();
+	void rebuildObjectField();
+	void finishReset();
+	void updateActiveObject();
 };
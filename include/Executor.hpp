@@ -1,23 +1,49 @@
 #pragma once
 
-#include <SFML/System/Vector2.hpp>
+#include "CoreTypes.hpp"
+#include <cstdint>
 #include <functional>
 
 class Environment2D;
 class Option;
+struct OptionContext;
 
 enum class Action;
 
+// Why an option stopped running
+enum class OptionTermination : std::uint8_t {
+	Goal,        // its goal held (possibly before the first step)
+	MaxSteps,    // ran out of its step budget
+	Stuck,       // the robot stayed in one cell for 3 steps
+	RewardFloor  // accumulated reward fell below the give-up floor
+};
+
+// Outcome of one option execution. The executor's shaping adjustments (stuck,
+// no-progress and clearing terms) count as received on the option's last step.
+struct OptionResult {
+	float reward = 0.f;           // undiscounted sum of rewards
+	float discountedReward = 0.f; // sum of gamma^i * r_i over the option's steps
+	int steps = 0;                // primitive steps taken
+	OptionTermination reason = OptionTermination::MaxSteps;
+};
+
 class OptionExecutor {
 public:
+	// gamma discounts rewards within an option; pass the planner's gamma
+	explicit OptionExecutor(float discount = 0.95f) : gamma(discount) {}
+
 	void tick(Environment2D& env, float dt);
 
-	float runPrimitiveUntil(Environment2D& env, int maxSteps,
+	OptionResult runPrimitiveUntil(Environment2D& env, int maxSteps,
 		const std::function<bool(const Environment2D&)>& goal,
 		const std::function<Action(const Environment2D&)>& policy);
 
-	float executeOption(Environment2D& env, const Option& option, int maxSteps);
+	// Run option with the rollout state in ctx (see OptionContext)
+	OptionResult executeOption(Environment2D& env, const Option& option, OptionContext& ctx, int maxSteps);
 	
 	// Version that accepts phase information for phase-specific reward handling
-	float executeOption(Environment2D& env, const Option& option, int maxSteps, int currentPhase);
+	OptionResult executeOption(Environment2D& env, const Option& option, OptionContext& ctx, int maxSteps, int currentPhase);
+
+private:
+	float gamma;
 };
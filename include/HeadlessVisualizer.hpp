@@ -0,0 +1,18 @@
+#pragma once
+
+class Environment2D;
+
+// Drop-in stand-in for Visualizer when the trainer is built without SFML.
+// Every call is a no-op so the training loop runs unchanged on headless nodes.
+class HeadlessVisualizer {
+public:
+	HeadlessVisualizer(unsigned int width, unsigned int height) { (void)width; (void)height; }
+	bool isOpen() const { return true; }
+	void pollEvents(bool& shouldClose, bool& resetRequested) { shouldClose = false; resetRequested = false; }
+	void render(Environment2D& env) { (void)env; }
+	void renderWithOverlay(Environment2D& env, int episode, float totalReward, float successRate) {
+		(void)env; (void)episode; (void)totalReward; (void)successRate;
+	}
+	float frame() { return 0.f; }
+	void delay(int milliseconds) { (void)milliseconds; }
+};
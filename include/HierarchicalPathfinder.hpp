@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "CoreTypes.hpp"
+
+class Environment2D;
+
+// Hierarchical obstacle-avoiding search (HPA*, Botea et al. 2004) for large
+// maps. The grid is cut into clusterSize x clusterSize clusters; every run of
+// cells passable on both sides of a cluster border gets one transition (two,
+// at its ends, for runs of 6 or more), and each cluster stores the in-cluster
+// BFS distances between its transition cells. A query links start and goal to
+// their clusters' transition cells, runs A* over that abstract graph and
+// refines each abstract edge with a BFS confined to one cluster, so its cost
+// depends on cluster size and path length rather than map area. Paths are
+// valid and complete but may be a few steps longer than the shortest.
+//
+// Like DStarLite, grid edits are read from the environment's change log; a
+// flipped cell rebuilds only its cluster (and the neighbors sharing a border
+// it lies on). A new grid size or log epoch rebuilds everything.
+class HierarchicalPathfinder {
+public:
+	explicit HierarchicalPathfinder(int clusterSize = 16) : size(clusterSize < 4 ? 4 : clusterSize) {}
+
+	// Path from start to goal avoiding obstacles (boundary cells are never
+	// entered), written to `out` without the start cell. False if unreachable.
+	bool findPath(const Environment2D& env, const Vec2i& start, const Vec2i& goal, std::vector<Vec2i>& out);
+
+	int clusterSize() const { return size; }
+	std::size_t nodeCount() const;
+	// Abstract nodes expanded by the last query
+	std::size_t lastExpanded() const { return expanded; }
+	// Clusters rebuilt while syncing for the last query
+	std::size_t lastRebuilt() const { return rebuilt; }
+	std::size_t sizeBytes() const;
+
+private:
+	static constexpr std::int32_t kInf = std::numeric_limits<std::int32_t>::max() / 4;
+	struct Transition { int a; int b; };  // a in the lower-numbered cluster
+	struct Link { int local; int other; }; // transition from a cluster's node to a neighbor cell
+	struct Cluster {
+		std::vector<int> nodes;           // transition cells inside the cluster
+		std::vector<Link> links;
+		std::vector<std::int32_t> dist;   // nodes.size()^2 in-cluster distances
+	};
+	struct HeapEntry { std::int32_t f; int cell; };
+	struct Edge { int cell; std::int32_t cost; };
+
+	int size;
+	int w = 0;
+	int h = 0;
+	int cw = 0; // clusters per row / column
+	int ch = 0;
+	std::uint64_t epoch = 0;
+	std::size_t logPos = 0;
+	bool built = false;
+	std::vector<std::uint8_t> open;            // passable copy the hierarchy was built on
+	std::vector<std::vector<Transition>> borders; // vertical borders first, then horizontal
+	std::vector<Cluster> clusters;
+	std::vector<int> localIndex;               // cell -> index in its cluster's nodes, or -1
+	std::vector<std::uint8_t> borderDirty;
+	std::vector<std::uint8_t> clusterDirty;
+	std::vector<int> dirtyBorders;
+	std::vector<int> dirtyClusters;
+
+	// query scratch, stamped per query like Pathfinder
+	std::uint32_t stampEpoch = 0;
+	std::vector<std::uint32_t> stamp;
+	std::vector<std::uint32_t> closed;
+	std::vector<std::int32_t> g;
+	std::vector<std::int32_t> parent;
+	std::vector<HeapEntry> heap;
+	std::vector<Edge> startEdges;        // start -> transition cells (and goal)
+	std::vector<std::int32_t> goalDist;  // goal cluster nodes -> goal
+	std::vector<int> abstractPath;
+	// in-cluster BFS scratch
+	std::vector<std::int32_t> localDist;
+	std::vector<int> localQueue;
+	std::size_t expanded = 0;
+	std::size_t rebuilt = 0;
+
+	void sync(const Environment2D& env);
+	void buildAll(const Environment2D& env);
+	void markCell(int cell);
+	void markBorder(int border);
+	void markCluster(int c);
+	void rebuildBorder(int border);
+	void rebuildCluster(int c);
+	int clusterOf(int cell) const { return (cell / w) / size * cw + (cell % w) / size; }
+	bool passable(int x, int y) const { return open[y * w + x] != 0; }
+	// BFS from `from` confined to cluster c; fills localDist (cluster-local cells)
+	void clusterBfs(int c, int from);
+	std::int32_t localDistTo(int c, int cell) const;
+	// Append the cells of a shortest in-cluster path from `from` (which may be
+	// a closed cell, or a start just outside c) to `to`
+	bool refine(int c, int from, int to, std::vector<Vec2i>& out);
+	// min-heap order for the std heap algorithms
+	static bool heapAfter(const HeapEntry& a, const HeapEntry& b);
+	void push(int cell, std::int32_t f);
+	void nextStamp();
+};
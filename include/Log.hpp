@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <thread>
+
+// Leveled logging for the training loop.
+//
+// Messages below O3F_LOG_LEVEL are compiled out entirely: the macro expands to
+// an empty statement and its arguments are never evaluated. Release builds
+// (NDEBUG) default to Info, so Trace/Debug calls in the step path cost nothing.
+// Enabled messages are formatted into a fixed per-thread buffer and pushed onto
+// a lock-free ring; a background thread drains it to stdout/stderr, so callers
+// never block on terminal I/O or flush per line.
+//
+// Usage: O3F_LOG_DEBUG("Env: cleared obstacle at (" << x << "," << y << ")");
+
+enum class LogLevel { Trace = 0, Debug = 1, Info = 2, Warn = 3, Error = 4, Off = 5 };
+
+#ifndef O3F_LOG_LEVEL
+#ifdef NDEBUG
+#define O3F_LOG_LEVEL 2
+#else
+#define O3F_LOG_LEVEL 0
+#endif
+#endif
+
+class Logger {
+public:
+	static constexpr std::size_t kMessageSize = 240;
+	static constexpr std::size_t kCapacity = 1024; // ring slots, power of two
+
+	static Logger& instance();
+
+	// Runtime threshold on top of the compile-time one
+	void setLevel(LogLevel level) { threshold.store(static_cast<int>(level), std::memory_order_relaxed); }
+	LogLevel getLevel() const { return static_cast<LogLevel>(threshold.load(std::memory_order_relaxed)); }
+	bool enabled(LogLevel level) const { return static_cast<int>(level) >= threshold.load(std::memory_order_relaxed); }
+
+	// Enqueue one message (truncated to kMessageSize). Never blocks; when the
+	// ring is full the message is dropped and counted.
+	void write(LogLevel level, const char* text, std::size_t len);
+	// Block until every message enqueued so far has been written out
+	void flush();
+	std::uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+	// Per-thread stream over a fixed buffer, reset for every message
+	std::ostream& beginMessage();
+	void endMessage(LogLevel level);
+
+	~Logger();
+	Logger(const Logger&) = delete;
+	Logger& operator=(const Logger&) = delete;
+
+private:
+	Logger();
+
+	struct Slot {
+		std::atomic<std::size_t> sequence;
+		LogLevel level;
+		std::uint32_t length;
+		char text[kMessageSize];
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	alignas(64) std::atomic<std::size_t> enqueuePos{0};
+	alignas(64) std::atomic<std::size_t> dequeuePos{0};
+	alignas(64) std::atomic<std::size_t> writtenPos{0};
+	std::atomic<std::uint64_t> dropped{0};
+	std::atomic<int> threshold{O3F_LOG_LEVEL};
+	std::atomic<bool> stopping{false};
+	std::thread drainThread;
+
+	void drainLoop();
+	bool drainOnce();
+};
+
+// Parse "trace", "debug", "info", "warn", "error" or "off"; returns false otherwise
+bool parseLogLevel(const char* name, LogLevel& out);
+
+#define O3F_LOG_AT(level, expr) \
+	do { \
+		if (Logger::instance().enabled(level)) { \
+			Logger::instance().beginMessage() << expr; \
+			Logger::instance().endMessage(level); \
+		} \
+	} while (0)
+
+#if O3F_LOG_LEVEL <= 0
+#define O3F_LOG_TRACE(expr) O3F_LOG_AT(LogLevel::Trace, expr)
+#else
+#define O3F_LOG_TRACE(expr) do {} while (0)
+#endif
+
+#if O3F_LOG_LEVEL <= 1
+#define O3F_LOG_DEBUG(expr) O3F_LOG_AT(LogLevel::Debug, expr)
+#else
+#define O3F_LOG_DEBUG(expr) do {} while (0)
+#endif
+
+#if O3F_LOG_LEVEL <= 2
+#define O3F_LOG_INFO(expr) O3F_LOG_AT(LogLevel::Info, expr)
+#else
+#define O3F_LOG_INFO(expr) do {} while (0)
+#endif
+
+#if O3F_LOG_LEVEL <= 3
+#define O3F_LOG_WARN(expr) O3F_LOG_AT(LogLevel::Warn, expr)
+#else
+#define O3F_LOG_WARN(expr) do {} while (0)
+#endif
+
+#if O3F_LOG_LEVEL <= 4
+#define O3F_LOG_ERROR(expr) O3F_LOG_AT(LogLevel::Error, expr)
+#else
+#define O3F_LOG_ERROR(expr) do {} while (0)
+#endif
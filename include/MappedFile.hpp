@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// The binary formats mapped through this class (scenario corpora, Q-table
+// checkpoints) are little-endian and read in place as host structs, so only
+// little-endian targets are supported; CMakeLists.txt checks the same at
+// configure time for compilers without these macros
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "mapped binary formats require a little-endian target");
+#endif
+
+// Read-only memory mapping of a whole file (mmap on POSIX, a file mapping view
+// on Windows). Pages are faulted in on first touch, so opening a multi-GB file
+// is O(1) and only the records actually read cost I/O.
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile() { close(); }
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept { *this = static_cast<MappedFile&&>(other); }
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	bool open(const std::string& path);
+	void close();
+
+	bool isOpen() const { return bytes != nullptr; }
+	const std::uint8_t* data() const { return bytes; }
+	std::size_t size() const { return length; }
+
+private:
+	const std::uint8_t* bytes = nullptr;
+	std::size_t length = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+
+#include "CoreTypes.hpp"
+#include "PathCache.hpp"
+
+class Environment2D;
+
+enum class Action;
+
+// Search helpers behind the option policies (src/Option.cpp), exposed so the
+// benchmarks time exactly what the options run. Obstacle-avoiding searches use
+// the flat per-thread Pathfinder, or the environment's hierarchy on large maps.
+
+// Shortest path from the robot to target (start cell excluded) into out, reusing
+// its capacity; false and out empty if unreachable
+bool bfsFullPath(const Environment2D& env, const Vec2i& target, std::vector<Vec2i>& out, PathMode mode = PathMode::AvoidObstacles);
+
+// First move of a shortest obstacle-avoiding path from the robot toward target
+Action bfsNextAction(const Environment2D& env, const Vec2i& target);
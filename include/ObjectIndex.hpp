@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "CoreTypes.hpp"
+
+// Uniform bucket grid over object cells for "nearest object" queries.
+// The bucket side is chosen on reset() from the expected object count so a
+// bucket holds about one object; a query scans rings of buckets outward from
+// the query cell and stops once no unvisited ring can hold anything closer.
+// That keeps queries O(1) on average whether a map has one object or hundreds.
+class ObjectIndex {
+public:
+	// Empty the index and size the buckets for about `expectedCount` objects
+	void reset(int gridWidth, int gridHeight, std::size_t expectedCount);
+
+	void insert(const Vec2i& cell);
+	bool erase(const Vec2i& cell);
+	bool contains(const Vec2i& cell) const;
+
+	std::size_t size() const { return cells.size(); }
+	bool empty() const { return cells.empty(); }
+	// Indexed cells in no particular order
+	const std::vector<Vec2i>& items() const { return cells; }
+
+	// Closest indexed cell to `from` by Manhattan distance, ties broken by the
+	// smaller (y, x). Returns false when the index is empty.
+	bool nearest(const Vec2i& from, Vec2i& out) const;
+
+	std::size_t sizeBytes() const;
+
+private:
+	int w = 0;
+	int h = 0;
+	int bucketSide = 1;
+	int bucketsX = 0;
+	int bucketsY = 0;
+	std::vector<std::vector<Vec2i>> buckets;
+	std::vector<Vec2i> cells;
+
+	int bucketOf(const Vec2i& c) const { return (c.y / bucketSide) * bucketsX + c.x / bucketSide; }
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One bit per grid cell marking obstacles, kept next to the CellType grid.
+// Rows are padded with a zero border column on each side and a zero row above
+// and below, so neighbor lookups never need bounds checks: cells outside the
+// grid read as "no obstacle". A 1000x1000 map fits in ~125 KB instead of 4 MB.
+class ObstacleBitboard {
+public:
+	// Neighbor mask bits, in the same order as the dx/dy tables used by Env
+	enum Neighbor : unsigned { Right = 1u, Left = 2u, Down = 4u, Up = 8u };
+
+	void resize(int width, int height) {
+		w = width;
+		h = height;
+		wordsPerRow = (w + 2 + 63) / 64;
+		// one trailing word so window() may always read the word after its first
+		words.assign(static_cast<std::size_t>(wordsPerRow) * (h + 2) + 1, 0);
+	}
+
+	void clear() { std::fill(words.begin(), words.end(), 0); }
+
+	void set(int x, int y) { word(x + 1, y + 1) |= bit(x + 1); }
+	void reset(int x, int y) { word(x + 1, y + 1) &= ~bit(x + 1); }
+	bool test(int x, int y) const { return (word(x + 1, y + 1) >> ((x + 1) & 63)) & 1u; }
+
+	// Obstacle bits of the four neighbors of (x, y) as a Neighbor mask.
+	// (x, y) must be inside the grid; off-grid neighbors read as empty.
+	unsigned neighborMask(int x, int y) const {
+		const unsigned row = window(x, y + 1);
+		const unsigned up = static_cast<unsigned>(word(x + 1, y) >> ((x + 1) & 63)) & 1u;
+		const unsigned down = static_cast<unsigned>(word(x + 1, y + 2) >> ((x + 1) & 63)) & 1u;
+		return ((row >> 2) & 1u) | ((row & 1u) << 1) | (down << 2) | (up << 3);
+	}
+
+	// Obstacle bits of cells x = 64*k .. 64*k+63 of row y (bit i = cell 64*k+i);
+	// columns past the grid read as empty. k may go up to (width + 63) / 64 - 1.
+	std::uint64_t rowWord(int y, int k) const {
+		const std::size_t i = static_cast<std::size_t>(y + 1) * wordsPerRow + k;
+		return (words[i] >> 1) | (words[i + 1] << 63);
+	}
+
+	std::size_t sizeBytes() const { return words.size() * sizeof(std::uint64_t); }
+
+private:
+	int w = 0;
+	int h = 0;
+	int wordsPerRow = 0;
+	std::vector<std::uint64_t> words;
+
+	static std::uint64_t bit(int paddedX) { return std::uint64_t(1) << (paddedX & 63); }
+	std::uint64_t& word(int paddedX, int paddedY) { return words[paddedY * wordsPerRow + (paddedX >> 6)]; }
+	std::uint64_t word(int paddedX, int paddedY) const { return words[paddedY * wordsPerRow + (paddedX >> 6)]; }
+
+	// Three bits starting at padded column x (cells x-1, x, x+1) of padded row,
+	// stitched across a word boundary without branching
+	unsigned window(int x, int paddedRow) const {
+		const std::size_t i = static_cast<std::size_t>(paddedRow) * wordsPerRow + (x >> 6);
+		const unsigned off = static_cast<unsigned>(x & 63);
+		const std::uint64_t lo = words[i] >> off;
+		const std::uint64_t hi = (words[i + 1] << 1) << (63 - off);
+		return static_cast<unsigned>(lo | hi) & 7u;
+	}
+};
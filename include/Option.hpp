@@ -1,117 +1,200 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <functional>
-#include <SFML/System/Vector2.hpp>
+#include "CoreTypes.hpp"
+#include "PathCache.hpp"
 
 class Environment2D;
 
 enum class Action;
 
+// Integer identity of each option type. The executor switches on it to call the
+// concrete option's goal and policy directly instead of through std::function.
+// Options defined outside this header report Custom and run through goal()/policy().
+enum class OptionId : std::uint8_t {
+	MoveToTarget,
+	GraspTarget,
+	ClearObstacle,
+	MoveToObject,
+	MoveObjectToTarget,
+	ReturnToObject,
+	Custom
+};
+constexpr std::size_t kOptionIdCount = 7;
+
+// The last few moves of one option and how often the newest one has repeated
+// back to back, in a fixed ring so recording a move never shifts or allocates
+class MoveHistory {
+public:
+	static constexpr std::size_t kCapacity = 8;
+
+	void clear() { count = 0; repeats = 0; }
+	void push(Action a) {
+		repeats = (count > 0 && moves[newest] == a) ? repeats + 1 : 1;
+		newest = (newest + 1) & (kCapacity - 1);
+		moves[newest] = a;
+		if (count < kCapacity) ++count;
+	}
+	// Restart the repeat count without forgetting the moves
+	void resetRepeats() { repeats = 0; }
+	int consecutiveRepeats() const { return repeats; }
+	std::size_t size() const { return count; }
+
+private:
+	std::array<Action, kCapacity> moves{};
+	std::size_t newest = 0;
+	std::size_t count = 0;
+	int repeats = 0;
+};
+
+// Everything an option changes while it runs, kept apart from the option
+// definitions so one makeDefaultOptions() set can drive any number of
+// episodes at once, each with its own context
+struct OptionContext {
+	std::array<MoveHistory, kOptionIdCount> moves; // per option, indexed by OptionId
+	std::vector<Vec2i> pathToObject;               // recorded by MoveToObject on select
+	std::vector<Vec2i> returnPath;                 // followed in reverse by MoveObjectToTarget
+	std::size_t returnPathIndex = 0;
+	Vec2i objectPickupLocation{-1, -1};
+	PathCache pathCache;
+
+	MoveHistory& history(OptionId id) { return moves[static_cast<std::size_t>(id)]; }
+	void setReturnPath(const std::vector<Vec2i>& path) {
+		returnPath = path;
+		returnPathIndex = 0;
+	}
+	// Back to the state of a fresh episode, keeping buffer capacity
+	void reset();
+};
+
+// Free list of contexts for concurrent rollouts: acquire() hands out a reset
+// context (allocating only when none is free), release() returns it
+class OptionContextPool {
+public:
+	OptionContext& acquire();
+	void release(OptionContext& ctx);
+	std::size_t size() const;
+
+private:
+	mutable std::mutex mutex;
+	std::vector<std::unique_ptr<OptionContext>> contexts;
+	std::vector<OptionContext*> freeList;
+};
+
+// Option definitions are immutable after construction: all rollout state
+// lives in the OptionContext passed in, so one instance may be shared between
+// threads as long as each rollout has its own context.
 class Option {
 public:
 	virtual ~Option() = default;
+	// Built-in ids are reserved for the final classes below; the executor casts to them
+	virtual OptionId id() const { return OptionId::Custom; }
 	virtual const std::string& name() const = 0;
-	virtual void onSelect(Environment2D& env) = 0;
+	virtual void onSelect(Environment2D& env, OptionContext& ctx) const = 0;
 	virtual bool isComplete(const Environment2D& env) const = 0;
 	virtual std::function<bool(const Environment2D&)> goal() const = 0;
-	virtual std::function<Action(const Environment2D&)> policy() const = 0;
+	// The returned policy reads and updates ctx, which must outlive it
+	virtual std::function<Action(const Environment2D&)> policy(OptionContext& ctx) const = 0;
 };
 
-class MoveToTargetOption : public Option {
+class MoveToTargetOption final : public Option {
 public:
 	MoveToTargetOption();
+	OptionId id() const override { return OptionId::MoveToTarget; }
 	const std::string& name() const override { return optionName; }
-	void onSelect(Environment2D& env) override;
+	void onSelect(Environment2D& env, OptionContext& ctx) const override;
 	bool isComplete(const Environment2D& env) const override;
 	std::function<bool(const Environment2D&)> goal() const override;
-	std::function<Action(const Environment2D&)> policy() const override;
+	std::function<Action(const Environment2D&)> policy(OptionContext& ctx) const override;
+	// Goal test and policy step called directly by OptionExecutor
+	bool reached(const Environment2D& env) const;
+	Action act(const Environment2D& env, OptionContext& ctx) const;
 private:
 	std::string optionName;
-	mutable std::vector<Action> moveHistory;  // Track last moves to detect loops
-	mutable int consecutiveRepeatedMoves = 0; // Count of repeated moves
 };
 
-class GraspTargetOption : public Option {
+class GraspTargetOption final : public Option {
 public:
 	GraspTargetOption();
+	OptionId id() const override { return OptionId::GraspTarget; }
 	const std::string& name() const override { return optionName; }
-	void onSelect(Environment2D& env) override;
+	void onSelect(Environment2D& env, OptionContext& ctx) const override;
 	bool isComplete(const Environment2D& env) const override;
 	std::function<bool(const Environment2D&)> goal() const override;
-	std::function<Action(const Environment2D&)> policy() const override;
+	std::function<Action(const Environment2D&)> policy(OptionContext& ctx) const override;
 private:
 	std::string optionName;
 };
 
-class ClearObstacleOption : public Option {
+class ClearObstacleOption final : public Option {
 public:
-    ClearObstacleOption();
-    const std::string& name() const override { return optionName; }
-    void onSelect(Environment2D& env) override;
-    bool isComplete(const Environment2D& env) const override;
-    std::function<bool(const Environment2D&)> goal() const override;
-    std::function<Action(const Environment2D&)> policy() const override;
+	ClearObstacleOption();
+	OptionId id() const override { return OptionId::ClearObstacle; }
+	const std::string& name() const override { return optionName; }
+	void onSelect(Environment2D& env, OptionContext& ctx) const override;
+	bool isComplete(const Environment2D& env) const override;
+	std::function<bool(const Environment2D&)> goal() const override;
+	std::function<Action(const Environment2D&)> policy(OptionContext& ctx) const override;
+	// Goal test and policy step called directly by OptionExecutor
+	bool reached(const Environment2D& env) const;
+	Action act(const Environment2D& env, OptionContext& ctx) const;
 private:
-    std::string optionName;
+	std::string optionName;
 };
 
-class MoveToObjectOption : public Option {
+class MoveToObjectOption final : public Option {
 public:
 	MoveToObjectOption();
+	OptionId id() const override { return OptionId::MoveToObject; }
 	const std::string& name() const override { return optionName; }
-	void onSelect(Environment2D& env) override;
+	void onSelect(Environment2D& env, OptionContext& ctx) const override;
 	bool isComplete(const Environment2D& env) const override;
 	std::function<bool(const Environment2D&)> goal() const override;
-	std::function<Action(const Environment2D&)> policy() const override;
-	
-	// Path storage for returning to target
-	const std::vector<sf::Vector2i>& getPathToObject() const { return pathToObject; }
-	void setPathToObject(const std::vector<sf::Vector2i>& path) { pathToObject = path; }
+	std::function<Action(const Environment2D&)> policy(OptionContext& ctx) const override;
+	// Goal test and policy step called directly by OptionExecutor
+	bool reached(const Environment2D& env) const;
+	Action act(const Environment2D& env, OptionContext& ctx) const;
 private:
 	std::string optionName;
-	std::vector<sf::Vector2i> pathToObject;
-	mutable std::vector<Action> moveHistory;  // Track last moves
-	mutable int consecutiveRepeatedMoves = 0;
 };
 
-class MoveObjectToTargetOption : public Option {
+class MoveObjectToTargetOption final : public Option {
 public:
 	MoveObjectToTargetOption();
+	OptionId id() const override { return OptionId::MoveObjectToTarget; }
 	const std::string& name() const override { return optionName; }
-	void onSelect(Environment2D& env) override;
+	void onSelect(Environment2D& env, OptionContext& ctx) const override;
 	bool isComplete(const Environment2D& env) const override;
 	std::function<bool(const Environment2D&)> goal() const override;
-	std::function<Action(const Environment2D&)> policy() const override;
-	
-	// Use the path from MoveToObjectOption to return
-	void setReturnPath(const std::vector<sf::Vector2i>& path) { 
-		returnPath = path; 
-		returnPathIndex = 0;  // Reset index when path is set
-	}
+	std::function<Action(const Environment2D&)> policy(OptionContext& ctx) const override;
+	// Goal test and policy step called directly by OptionExecutor
+	bool reached(const Environment2D& env) const;
+	Action act(const Environment2D& env, OptionContext& ctx) const;
 private:
 	std::string optionName;
-	sf::Vector2i objectPickupLocation;
-	std::vector<sf::Vector2i> returnPath;
-	mutable size_t returnPathIndex = 0;  // mutable to allow modification in const policy()
-	mutable std::vector<Action> moveHistory;  // Track last moves
-	mutable int consecutiveRepeatedMoves = 0;
 };
 
-class ReturnToObjectOption : public Option {
+class ReturnToObjectOption final : public Option {
 public:
 	ReturnToObjectOption();
+	OptionId id() const override { return OptionId::ReturnToObject; }
 	const std::string& name() const override { return optionName; }
-	void onSelect(Environment2D& env) override;
+	void onSelect(Environment2D& env, OptionContext& ctx) const override;
 	bool isComplete(const Environment2D& env) const override;
 	std::function<bool(const Environment2D&)> goal() const override;
-	std::function<Action(const Environment2D&)> policy() const override;
+	std::function<Action(const Environment2D&)> policy(OptionContext& ctx) const override;
+	// Goal test and policy step called directly by OptionExecutor
+	bool reached(const Environment2D& env) const;
+	Action act(const Environment2D& env, OptionContext& ctx) const;
 private:
 	std::string optionName;
-	mutable std::vector<Action> moveHistory;  // Track last moves
-	mutable int consecutiveRepeatedMoves = 0;
 };
 
 std::vector<std::unique_ptr<Option>> makeDefaultOptions();
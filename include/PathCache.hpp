@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CoreTypes.hpp"
+
+// How a grid search treats obstacles (boundary cells are never entered)
+enum class PathMode : std::uint8_t {
+	AvoidObstacles,  // impassable
+	IgnoreObstacles, // passable at unit cost
+	ObstacleCost     // passable at unit cost plus the cost of clearing them
+};
+
+// Small cache of searched paths for option policies. An entry is keyed by
+// (goal, mode, grid generation) and answers for every start cell that lies on
+// its path, so a robot following the path gets its next move in O(1) until
+// the environment's generation changes. Entries are replaced round-robin.
+class PathCache {
+public:
+	// Next cell after `start` toward `goal` if a current entry passes through start
+	bool next(const Vec2i& start, const Vec2i& goal, PathMode mode, std::uint64_t generation, Vec2i& out);
+	// Remember `path` (the cells after `start`, ending at the goal)
+	void store(const Vec2i& start, const Vec2i& goal, PathMode mode, std::uint64_t generation, const std::vector<Vec2i>& path);
+	void clear();
+
+	std::uint64_t hits() const { return hitCount; }
+	std::uint64_t misses() const { return missCount; }
+
+private:
+	static constexpr std::size_t kEntries = 4;
+	struct Entry {
+		bool used = false;
+		Vec2i goal;
+		PathMode mode = PathMode::AvoidObstacles;
+		std::uint64_t generation = 0;
+		std::vector<Vec2i> cells; // start first, goal last
+		std::size_t cursor = 0;   // position of the last start served
+	};
+	std::array<Entry, kEntries> entries;
+	std::size_t victim = 0;
+	std::uint64_t hitCount = 0;
+	std::uint64_t missCount = 0;
+};
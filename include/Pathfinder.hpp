@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CoreTypes.hpp"
+#include "PathCache.hpp"
+
+class Environment2D;
+
+// Search strategy for Pathfinder::findPath
+enum class PathAlgorithm : std::uint8_t {
+	Bfs,   // uniform-cost search expanding in order of path cost (plain BFS for unit costs)
+	AStar  // same, ordered by cost + Manhattan distance to the goal
+};
+
+// Minimum-cost route when obstacles may be cleared: the cells to walk (start
+// excluded) and the obstacles on them, in the order they are reached
+struct ClearingPlan {
+	std::vector<Vec2i> path;
+	std::vector<Vec2i> clears;
+	int cost = 0; // steps + obstacleCost * clears.size()
+};
+
+// Reusable 4-connected grid search over an Environment2D. Visited/cost/parent
+// live in flat per-cell buffers stamped with a query epoch, so a query never
+// clears or allocates them, and the open list is a ring of cost buckets (Dial's
+// algorithm) whose storage is kept between queries. After the first query on a
+// grid size, searches do no heap allocation as long as `out` has capacity.
+//
+// Boundary cells are never entered. PathMode decides obstacles: AvoidObstacles
+// skips them, IgnoreObstacles walks through them at unit cost, ObstacleCost
+// walks through them at 1 + obstacleCost (the price of clearing one).
+// Neighbors expand in right, left, down, up order and ties keep the first
+// parent found, so Bfs paths match a textbook queue-based BFS.
+class Pathfinder {
+public:
+	explicit Pathfinder(int obstacleCost = 2) : clearCost(obstacleCost) {}
+
+	// Shortest path from start to goal written to `out` without the start
+	// cell. Returns false (and leaves `out` empty) when goal is unreachable.
+	bool findPath(const Environment2D& env, const Vec2i& start, const Vec2i& goal, PathMode mode,
+		std::vector<Vec2i>& out, PathAlgorithm algorithm = PathAlgorithm::Bfs);
+
+	// Path minimizing steps + obstacleCost * obstacles cleared (ObstacleCost
+	// mode, A*) together with the obstacles it clears
+	bool findClearingPath(const Environment2D& env, const Vec2i& start, const Vec2i& goal, ClearingPlan& plan);
+
+	// Cost of the last successful findPath (steps plus clearing costs)
+	int lastCost() const { return cost; }
+	// Cells expanded by the last query
+	std::size_t lastExpanded() const { return expanded; }
+	int obstacleCost() const { return clearCost; }
+	void setObstacleCost(int c) { clearCost = c < 0 ? 0 : c; }
+
+private:
+	int clearCost;
+	int w = 0;
+	int h = 0;
+	std::uint32_t epoch = 0;
+	std::vector<std::uint32_t> stamp; // == epoch: g/parent valid this query
+	std::vector<std::int32_t> g;
+	std::vector<std::int32_t> parent;
+	std::vector<std::uint32_t> closedStamp;
+	// ring of FIFO buckets; bucket b holds cells with priority == b (mod size)
+	std::vector<std::vector<std::int32_t>> buckets;
+	std::vector<std::size_t> bucketHead;
+	int cost = 0;
+	std::size_t expanded = 0;
+
+	void prepare(int width, int height, std::size_t ringSize);
+};
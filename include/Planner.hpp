@@ -1,12 +1,20 @@
 #pragma once
 
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <string>
 
+#include "ConcurrentQTable.hpp"
+#include "QTable.hpp"
+#include "ReplayBuffer.hpp"
+#include "Rng.hpp"
+
 class Environment2D;
 class Option;
+struct StateKey;
 
 struct PlannerConfig {
 	float alpha = 0.1f;         // Learning rate
@@ -14,26 +22,147 @@ struct PlannerConfig {
 	float epsilon = 0.3f;       // Initial exploration rate (decreased from 1.0)
 	float epsilonDecay = 0.995f; // Decay per episode
 	float epsilonMin = 0.05f;   // Minimum exploration
+	int planningSteps = 0;      // Dyna-Q: simulated backups from the option model per real update (0 = model-free)
+	std::uint64_t planningSeed = 0; // stream for picking simulated (state, option) samples and replay minibatches
+	int replayCapacity = 0;     // experience replay: transitions kept in the ring (0 = off)
+	int replayBatch = 32;       // transitions replayed after every real update
+	float replayPriority = 0.f; // prioritized replay exponent on |TD error| (0 = uniform)
+	float replayBeta = 0.4f;    // importance-sampling correction exponent for prioritized draws
+	// Several episode workers may share the planner when this is not None; the
+	// table is then fixed at numOptions columns, which must be set
+	QConcurrency concurrency = QConcurrency::None;
+	int numOptions = 0;
+	int mergeInterval = 64;     // ThreadDeltas: updates a worker buffers before merging
 };
 
 class OptionPlanner {
 public:
+	// Discrete planner state: distance bucket (4) x direction to target (9) x
+	// obstacle neighbor x carrying, packed into a dense id in [0, kNumStates)
+	static constexpr int kNumStates = 4 * 9 * 2 * 2;
+	// Bumped whenever stateId's layout changes; binary checkpoints record it
+	static constexpr std::uint32_t kStateEncodingVersion = 1;
+	static int stateId(const StateKey& key);
+	// CSV row key of a state id, "dist:direction:obstacle:carrying"
+	static std::string stateName(int id);
+	// Inverse of stateName; false for anything else
+	static bool parseStateName(const std::string& name, int& id);
+
 	OptionPlanner(PlannerConfig cfg);
-	// Save/load Q-table to CSV. CSV rows: state,q0,q1,...
+	// Import/export the Q-table as CSV. CSV rows: state,q0,q1,... for every
+	// state the planner has touched
 	bool saveQTable(const std::string& path) const;
 	bool loadQTable(const std::string& path);
+	// Versioned binary checkpoint (see QCheckpoint.hpp), written atomically;
+	// loading maps the file and rejects a bad checksum or state encoding
+	bool saveCheckpoint(const std::string& path) const;
+	bool loadCheckpoint(const std::string& path);
 	// Access to internal config so callers can read/update epsilon, decay, etc.
 	PlannerConfig& getConfig() { return config; }
 	const PlannerConfig& getConfig() const { return config; }
+	const QTable& getQTable() const { return qTable; }
+	// In a concurrent mode, merge pending updates and refresh getQTable() from
+	// the shared table; call while no worker is updating
+	void syncQTable();
 	int selectAction(const Environment2D& env, const std::vector<std::unique_ptr<Option>>& options);
 	void update(const Environment2D& prevEnv, int actionIdx, float reward, const Environment2D& nextEnv, int numActions);
+	// Same update from captured state keys, so callers need not copy the environment
+	// SMDP Q-learning: `reward` is the option's discounted return (OptionResult::
+	// discountedReward) and `steps` its duration k in primitive steps, so the
+	// bootstrap is discounted by gamma^k; steps = 1 is the one-step rule.
+	// With planningSteps > 0 the transition also trains the option model and is
+	// followed by that many simulated backups drawn from it. With replay on it is
+	// stored in the replay ring and a minibatch of stored transitions is replayed.
+	void update(const StateKey& prev, int actionIdx, float reward, const StateKey& next, int numActions, int steps = 1);
 
 	// explicit API per Step 6/7 naming
 	int selectOption(const Environment2D& env, const std::vector<std::unique_ptr<Option>>& options) { return selectAction(env, options); }
 	void updateQ(const Environment2D& prevEnv, int optionIdx, float optionReward, const Environment2D& nextEnv, int numActions) { update(prevEnv, optionIdx, optionReward, nextEnv, numActions); }
+	void updateQ(const StateKey& prev, int optionIdx, float optionReward, const StateKey& next, int numActions, int steps = 1) { update(prev, optionIdx, optionReward, next, numActions, steps); }
+
+	// Learned SMDP option model: for an observed (state, option) pair, how often
+	// it ran, its mean discounted return, duration and gamma^duration, and the
+	// number of outcomes seen
+	struct ModelStats {
+		int visits = 0;
+		float meanReward = 0.f;
+		float meanSteps = 0.f;
+		float meanDiscount = 0.f;
+		std::size_t outcomes = 0;
+	};
+	bool modelStats(const StateKey& state, int optionIdx, ModelStats& out) const;
+	// (state, option) pairs in the model and simulated backups run so far
+	std::size_t modelSize() const { return observed.size(); }
+	std::size_t planningBackups() const { return simulated; }
+
+	// Replay a minibatch of stored transitions (see ReplayBuffer.hpp) in slot
+	// order; returns the number of backups, 0 with replay off or empty. update()
+	// already replays replayBatch transitions; safe to call from workers in a
+	// concurrent mode
+	int replay(int batchSize);
+	std::size_t replaySize() const { return replayBuffer ? static_cast<std::size_t>(replayBuffer->size()) : 0; }
+	std::size_t replayBackups() const { return replayed; }
 
 private:
+	// One successor state of an option and how many times it was reached
+	struct Outcome {
+		int next;
+		int count;
+	};
+	struct OptionModel {
+		int visits = 0;
+		float meanReward = 0.f;
+		float meanSteps = 0.f;
+		float meanDiscount = 0.f; // E[gamma^k], the bootstrap factor of a simulated backup
+		std::vector<Outcome> outcomes;
+	};
+	struct Sample {
+		int state;
+		int option;
+	};
+	// A backup drawn from the option model or the replay ring, applied after
+	// the draw so concurrent workers hold modelMutex only while sampling
+	struct PendingBackup {
+		int state;
+		int option;
+		float reward;
+		int next;
+		float discount;
+		float step;
+		int slot; // replay slot, -1 for a Dyna backup
+		float td; // set when applied, for the slot's priority
+	};
+
 	PlannerConfig config;
-	std::string discretize(const Environment2D& env) const;
-	std::unordered_map<std::string, std::vector<float>> qTable;
+	QTable qTable;
+	std::unique_ptr<ConcurrentQTable> shared; // set in a concurrent mode, which then owns the live values
+	std::mutex modelMutex; // guards the Dyna model, the replay ring and their sampling streams
+	std::vector<std::vector<OptionModel>> models; // [state][option], filled as pairs are observed
+	std::vector<Sample> observed; // every (state, option) in the model, for uniform sampling
+	PhiloxEngine planRng;
+	std::size_t simulated = 0;
+	std::unique_ptr<ReplayBuffer> replayBuffer;
+	PhiloxEngine replayRng;
+	std::vector<int> replaySlots;     // sampleReplay scratch, under modelMutex
+	std::vector<float> replayWeights;
+	std::size_t replayed = 0;
+
+	// gamma^k for an option that ran k primitive steps (at least one decision)
+	float discountFor(int steps) const;
+	// Bootstraps with discount * max Q(next) and returns the TD error; `step`
+	// scales alpha (importance weights)
+	float backup(int s, int actionIdx, float reward, int next, float discount, float step = 1.f);
+	// Record a real transition in the model and ring, whichever are on, and
+	// draw the Dyna and replay backups that follow it (modelMutex held in a
+	// concurrent mode)
+	void collectExperience(int s, int actionIdx, float reward, int next, int steps, int numActions,
+		std::vector<PendingBackup>& batch);
+	void samplePlanning(int n, std::vector<PendingBackup>& batch);
+	void sampleReplay(int n, std::vector<PendingBackup>& batch);
+	// Apply drawn backups, then refresh replay priorities under the lock
+	void finishBackups(std::vector<PendingBackup>& batch);
+	static std::vector<PendingBackup>& scratchBatch();
+	// qTable, or in a concurrent mode a merged copy of the shared table in scratch
+	const QTable& exportTable(QTable& scratch) const;
+	void learnModel(int s, int actionIdx, float reward, int next, int steps, int numActions);
 };
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.hpp"
+
+class QTable;
+
+// Binary Q-table checkpoint: a fixed 64-byte header followed by the payload,
+// numStates * numActions floats in row-major order and then one touched byte
+// per state, zero-padded to a multiple of 8 bytes. All fields are
+// little-endian: they are written and mapped as raw host memory, which
+// MappedFile.hpp restricts to little-endian targets. The values start 64
+// bytes into the file, so a mapping hands out cache-line-aligned rows that
+// are read in place.
+constexpr char kCheckpointMagic[8] = {'O', '3', 'F', 'Q', 'T', 'B', 'L', '\0'};
+constexpr std::uint32_t kCheckpointVersion = 1;
+
+struct CheckpointHeader {
+	char magic[8];
+	std::uint32_t version;       // file layout (kCheckpointVersion)
+	std::uint32_t stateEncoding; // version of the state-id encoding the rows are indexed by
+	std::uint32_t numStates;
+	std::uint32_t numActions;
+	std::uint64_t payloadBytes;
+	std::uint64_t checksum;      // checkpointChecksum of the payload
+	std::uint8_t reserved[24];
+};
+static_assert(sizeof(CheckpointHeader) == 64, "checkpoint header layout");
+
+inline std::size_t checkpointPayloadBytes(std::uint32_t numStates, std::uint32_t numActions) {
+	std::size_t bytes = static_cast<std::size_t>(numStates) * numActions * sizeof(float) + numStates;
+	return (bytes + 7) / 8 * 8;
+}
+
+// FNV-1a over 64-bit little-endian words; `bytes` must be a multiple of 8
+std::uint64_t checkpointChecksum(const std::uint8_t* data, std::size_t bytes);
+
+// Write `table` to path + ".tmp", sync it to disk and rename it over `path`
+// (syncing the directory on POSIX), so readers and crash recovery see either
+// the previous checkpoint or the complete new one, never a torn file
+bool writeQCheckpoint(const std::string& path, const QTable& table, std::uint32_t stateEncoding);
+
+// Read-only view of a checkpoint file. open() maps the file and checks the
+// header and size only, so it is O(1) whatever the table size; verify() reads
+// the whole payload to check the checksum.
+class QCheckpointView {
+public:
+	bool open(const std::string& path);
+	bool verify() const;
+
+	bool isOpen() const { return header != nullptr; }
+	std::uint32_t stateEncoding() const { return header ? header->stateEncoding : 0; }
+	int numStates() const { return header ? static_cast<int>(header->numStates) : 0; }
+	int numActions() const { return header ? static_cast<int>(header->numActions) : 0; }
+
+	const float* row(int state) const { return values + static_cast<std::size_t>(state) * header->numActions; }
+	bool touched(int state) const { return touchedRows[state] != 0; }
+	// Greedy option for a state straight from the mapping (first of equal values)
+	int argmax(int state) const {
+		const float* q = row(state);
+		int best = 0;
+		for (int i = 1; i < numActions(); ++i) if (q[i] > q[best]) best = i;
+		return best;
+	}
+	// Copy into `table`, resizing it to the checkpoint's shape
+	void copyTo(QTable& table) const;
+
+private:
+	MappedFile file;
+	const CheckpointHeader* header = nullptr;
+	const float* values = nullptr;
+	const std::uint8_t* touchedRows = nullptr;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Dense Q-value table: numStates rows of numActions floats in one contiguous,
+// 64-byte-aligned float allocation, indexed by integer state id. A lookup is a
+// multiply-add instead of hashing a key and chasing a per-row allocation.
+// Rows remember whether they were ever touched, so exports can skip states
+// the agent never visited.
+class QTable {
+public:
+	QTable() = default;
+	QTable(int numStates, int numActions) { reset(numStates, numActions); }
+	QTable(const QTable& other) { *this = other; }
+	QTable& operator=(const QTable& other);
+	QTable(QTable&&) noexcept = default;
+	QTable& operator=(QTable&&) noexcept = default;
+
+	// All values zero, no row touched
+	void reset(int numStates, int numActions);
+	// Widen rows to at least numActions columns; existing values are kept and
+	// new columns start at zero
+	void ensureActions(int numActions);
+
+	int numStates() const { return states; }
+	int numActions() const { return actions; }
+
+	float* row(int state) { return values() + static_cast<std::size_t>(state) * actions; }
+	const float* row(int state) const { return values() + static_cast<std::size_t>(state) * actions; }
+	float& at(int state, int action) { return row(state)[action]; }
+	float at(int state, int action) const { return row(state)[action]; }
+
+	// Largest value in a row (0 for a table without actions)
+	float maxValue(int state) const {
+		const float* q = row(state);
+		return actions == 0 ? 0.0f : *std::max_element(q, q + actions);
+	}
+	// Index of the first largest value in a row
+	int argmax(int state) const {
+		const float* q = row(state);
+		int best = 0;
+		for (int i = 1; i < actions; ++i) if (q[i] > q[best]) best = i;
+		return best;
+	}
+
+	void touch(int state) { touchedRows[state] = 1; }
+	bool touched(int state) const { return touchedRows[state] != 0; }
+
+	std::size_t sizeBytes() const { return allocated * sizeof(float) + touchedRows.size(); }
+
+private:
+	static constexpr std::size_t kAlign = 64;
+	struct AlignedDelete {
+		void operator()(float* p) const { ::operator delete(p, std::align_val_t{kAlign}); }
+	};
+	using Storage = std::unique_ptr<float[], AlignedDelete>;
+
+	int states = 0;
+	int actions = 0;
+	std::size_t allocated = 0; // floats, rounded up to whole cache lines
+	Storage storage;
+	std::vector<std::uint8_t> touchedRows;
+
+	float* values() { return storage.get(); }
+	const float* values() const { return storage.get(); }
+	// Zeroed block for numStates x numActions values; `floats` receives its length
+	static Storage allocate(int numStates, int numActions, std::size_t& floats);
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class PhiloxEngine;
+
+// Fixed-capacity ring of option transitions (state id, option, return,
+// duration, next state id), one array per field so a replay pass reads each
+// field sequentially. Once full, the oldest transition is overwritten.
+//
+// With a priority exponent > 0 the buffer keeps a sum tree over
+// (|TD error| + epsilon)^exponent and samples proportionally; new transitions
+// enter at the largest priority seen so they are replayed at least once.
+class ReplayBuffer {
+public:
+	ReplayBuffer(int capacity, float priorityExponent = 0.0f);
+
+	void push(int state, int option, float reward, int duration, int next);
+	void clear();
+	int size() const { return count; }
+	int capacity() const { return static_cast<int>(states.size()); }
+	bool prioritized() const { return exponent > 0.0f; }
+
+	// n slots drawn with replacement, in ascending slot order: stratified over
+	// the priority mass when prioritized, uniform otherwise
+	void sample(int n, PhiloxEngine& rng, std::vector<int>& slots) const;
+	// Sampling probability of a slot
+	double probability(int slot) const;
+	void setPriority(int slot, float tdError);
+
+	int state(int slot) const { return states[slot]; }
+	int option(int slot) const { return options[slot]; }
+	float reward(int slot) const { return rewards[slot]; }
+	int duration(int slot) const { return durations[slot]; }
+	int next(int slot) const { return nexts[slot]; }
+
+private:
+	std::vector<std::int32_t> states;
+	std::vector<std::int32_t> options;
+	std::vector<float> rewards;
+	std::vector<std::int32_t> durations;
+	std::vector<std::int32_t> nexts;
+	int head = 0;
+	int count = 0;
+
+	float exponent;
+	float maxPriority = 1.0f;
+	std::size_t leaves = 0;   // power of two >= capacity
+	std::vector<double> tree; // sum tree: node i covers 2i and 2i+1, leaves at [leaves, 2*leaves)
+
+	void setLeaf(int slot, double priority);
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random
+// Numbers: As Easy as 1, 2, 3"). The whole state is a 64-bit key and a 128-bit
+// counter, so re-keying per episode costs a few stores instead of seeding a
+// 2.5 KB Mersenne Twister. Distinct (seed, stream) pairs give independent
+// sequences, which makes episode k's draws a pure function of (seed, k).
+// Satisfies UniformRandomBitGenerator.
+class PhiloxEngine {
+public:
+	using result_type = std::uint32_t;
+
+	PhiloxEngine() { seed(0, 0); }
+	PhiloxEngine(std::uint64_t key, std::uint64_t stream) { seed(key, stream); }
+
+	void seed(std::uint64_t key, std::uint64_t stream) {
+		k0 = static_cast<std::uint32_t>(key);
+		k1 = static_cast<std::uint32_t>(key >> 32);
+		ctr[0] = 0;
+		ctr[1] = 0;
+		ctr[2] = static_cast<std::uint32_t>(stream);
+		ctr[3] = static_cast<std::uint32_t>(stream >> 32);
+		used = 4;
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()() {
+		if (used == 4) refill();
+		return out[used++];
+	}
+
+	// Uniform integer in [lo, hi] (Lemire's multiply-shift with rejection).
+	// Unlike std::uniform_int_distribution the mapping is fixed, so the same
+	// seed yields the same maps with every standard library.
+	int uniformInt(int lo, int hi) {
+		const std::uint32_t range = static_cast<std::uint32_t>(hi - lo) + 1u;
+		if (range == 0) return static_cast<int>((*this)());
+		std::uint64_t m = static_cast<std::uint64_t>((*this)()) * range;
+		std::uint32_t low = static_cast<std::uint32_t>(m);
+		if (low < range) {
+			const std::uint32_t threshold = (0u - range) % range;
+			while (low < threshold) {
+				m = static_cast<std::uint64_t>((*this)()) * range;
+				low = static_cast<std::uint32_t>(m);
+			}
+		}
+		return lo + static_cast<int>(m >> 32);
+	}
+
+	// Uniform float in [0, 1) with 24 bits of precision
+	float uniformFloat() { return ((*this)() >> 8) * (1.0f / 16777216.0f); }
+
+private:
+	std::uint32_t k0 = 0;
+	std::uint32_t k1 = 0;
+	std::uint32_t ctr[4] = {0, 0, 0, 0};
+	std::uint32_t out[4] = {0, 0, 0, 0};
+	int used = 4;
+
+	void refill() {
+		std::uint32_t x[4] = {ctr[0], ctr[1], ctr[2], ctr[3]};
+		std::uint32_t a = k0;
+		std::uint32_t b = k1;
+		for (int round = 0; round < 10; ++round) {
+			const std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * x[0];
+			const std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * x[2];
+			const std::uint32_t hi0 = static_cast<std::uint32_t>(p0 >> 32);
+			const std::uint32_t lo0 = static_cast<std::uint32_t>(p0);
+			const std::uint32_t hi1 = static_cast<std::uint32_t>(p1 >> 32);
+			const std::uint32_t lo1 = static_cast<std::uint32_t>(p1);
+			x[0] = hi1 ^ x[1] ^ a;
+			x[1] = lo1;
+			x[2] = hi0 ^ x[3] ^ b;
+			x[3] = lo0;
+			a += 0x9E3779B9u;
+			b += 0xBB67AE85u;
+		}
+		out[0] = x[0]; out[1] = x[1]; out[2] = x[2]; out[3] = x[3];
+		used = 0;
+		// 64-bit block counter in the low words; the high words hold the stream
+		if (++ctr[0] == 0) ++ctr[1];
+	}
+};
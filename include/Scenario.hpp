@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "CoreTypes.hpp"
+#include "MappedFile.hpp"
+
+class Environment2D;
+
+// Binary scenario corpus: a fixed header followed by `count` fixed-size records.
+// Each record is a ScenarioRecord (robot/target/object cells) followed by the
+// obstacle bitmap, one bit per cell in row-major order (bit i of byte i/8),
+// padded to kScenarioAlign bytes. All fields are little-endian: records are
+// written and read as raw structs, which MappedFile.hpp restricts to
+// little-endian targets. Records are read straight out of the mapping;
+// nothing is parsed when the corpus opens.
+constexpr char kScenarioMagic[8] = {'O', '3', 'F', 'S', 'C', 'N', '\0', '\0'};
+constexpr std::uint32_t kScenarioVersion = 1;
+constexpr std::size_t kScenarioAlign = 8;
+
+struct ScenarioHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t recordBytes;
+	std::uint32_t gridWidth;
+	std::uint32_t gridHeight;
+	std::uint64_t count;
+};
+static_assert(sizeof(ScenarioHeader) == 32, "scenario header layout");
+
+struct ScenarioRecord {
+	std::uint16_t robotX, robotY;
+	std::uint16_t targetX, targetY;
+	std::uint16_t objectX, objectY;
+	std::uint16_t reserved[2];
+};
+static_assert(sizeof(ScenarioRecord) == 16, "scenario record layout");
+
+inline std::size_t scenarioRecordBytes(int gridWidth, int gridHeight) {
+	std::size_t bits = (static_cast<std::size_t>(gridWidth) * gridHeight + 7) / 8;
+	std::size_t bytes = sizeof(ScenarioRecord) + bits;
+	return (bytes + kScenarioAlign - 1) / kScenarioAlign * kScenarioAlign;
+}
+
+// Read-only view of a corpus file
+class ScenarioCorpus {
+public:
+	// Maps the file and checks the header and file size
+	bool open(const std::string& path);
+
+	bool isOpen() const { return header != nullptr; }
+	std::size_t size() const { return header ? static_cast<std::size_t>(header->count) : 0; }
+	int gridWidth() const { return header ? static_cast<int>(header->gridWidth) : 0; }
+	int gridHeight() const { return header ? static_cast<int>(header->gridHeight) : 0; }
+
+	const ScenarioRecord& record(std::size_t i) const {
+		return *reinterpret_cast<const ScenarioRecord*>(records + i * recordBytes);
+	}
+	const std::uint8_t* obstacleBits(std::size_t i) const {
+		return records + i * recordBytes + sizeof(ScenarioRecord);
+	}
+
+private:
+	MappedFile file;
+	const ScenarioHeader* header = nullptr;
+	const std::uint8_t* records = nullptr;
+	std::size_t recordBytes = 0;
+};
+
+// Streams scenarios to a corpus file; the header count is patched on close()
+class ScenarioWriter {
+public:
+	bool open(const std::string& path, int gridWidth, int gridHeight);
+	// Records the environment's current map; it must match the writer's grid
+	// size and hold exactly one (uncarried) object
+	bool append(const Environment2D& env);
+	bool close();
+
+	std::uint64_t count() const { return written; }
+
+private:
+	std::ofstream out;
+	int w = 0;
+	int h = 0;
+	std::uint64_t written = 0;
+	std::string buffer;
+};
@@ -22,4 +22,6 @@ private:
 	bool fontLoaded;
 	
 	void drawText(const std::string& text, float x, float y, sf::Color color = sf::Color::White);
+	// Draw the environment grid; the core environment has no graphics dependency
+	void drawGrid(const Environment2D& env);
 };
@@ -1,6 +1,9 @@
 #pragma once
 const int GRID_WIDTH = 30;
 const int GRID_HEIGHT = 20;
+// Smallest grid the map generator can lay out (target band, object band, border)
+const int MIN_GRID_WIDTH = 8;
+const int MIN_GRID_HEIGHT = 6;
 const float CELL_SIZE = 20.f;
 const float DISCOUNT = 0.9f;
 const float LEARNING_RATE = 0.1f;
@@ -4,32 +4,36 @@
 #include "Planner.hpp"
 #include "Executor.hpp"
 #include "Visualizer.hpp"
+#include "Log.hpp"
 
 #include <algorithm>
-#include <iostream>
 
 Agent::Agent(AgentConfig cfg) : config(cfg), currentOptionIdx(-1), timeSinceSelect(0.f) {}
 Agent::~Agent() = default;
 
 void Agent::initialize() {
 	options = makeDefaultOptions();
+	context.reset(new OptionContext());
 	planner.reset(new OptionPlanner(PlannerConfig{}));
-	executor.reset(new OptionExecutor());
+	executor.reset(new OptionExecutor(planner->getConfig().gamma));
 }
 
 float Agent::runEpisode(Environment2D& env, Visualizer& viz, int maxSteps) {
 	float cumulative = 0.f;
 	int steps = 0;
+	int episode = 0; // counts resets, whether on success or requested
+	context->reset();
 	
 	// State machine: 0=ClearObstacles, 1=MoveToTarget, 2=ReturnToObject, 3=MoveObjectToTarget
 	int currentPhase = 0;
-	const char* phaseNames[] = {"ClearObstacle", "MoveToTarget", "ReturnToObject", "MoveObjectToTarget"};
+	[[maybe_unused]] const char* phaseNames[] = {"ClearObstacle", "MoveToTarget", "ReturnToObject", "MoveObjectToTarget"};
 	
 	while (viz.isOpen() && steps < maxSteps) {
 		bool shouldClose = false, resetRequested = false;
 		viz.pollEvents(shouldClose, resetRequested);
 		if (shouldClose) break;
 		if (resetRequested) {
+			++episode;
 			env.reset(5);
 			currentPhase = 0;
 		}
@@ -40,14 +44,16 @@ float Agent::runEpisode(Environment2D& env, Visualizer& viz, int maxSteps) {
 		int optionIdx = currentPhase;
 		
 		// Execute the current phase's option
-		Environment2D prevState = env;
-		options[optionIdx]->onSelect(env);
-		float reward = executor->executeOption(env, *options[optionIdx], 20);
+		StateKey prevState = env.stateKey();
+		options[optionIdx]->onSelect(env, *context);
+		const OptionResult result = executor->executeOption(env, *options[optionIdx], *context, 20);
+		float reward = result.reward;
+		float optionReturn = result.discountedReward;
 		
 		// Print debug info
-		std::cout << "Episode " << steps / 20 << ", Phase: " << phaseNames[currentPhase] 
-				  << ", Reward: " << reward << ", Total: " << (cumulative + reward) 
-				  << ", Robot at (" << env.getRobotCell().x << "," << env.getRobotCell().y << ")" << std::endl;
+		O3F_LOG_DEBUG("Episode " << episode << ", Phase: " << phaseNames[currentPhase]
+				  << ", Reward: " << reward << ", Total: " << (cumulative + reward)
+				  << ", Robot at (" << env.getRobotCell().x << "," << env.getRobotCell().y << ")");
 		
 		// Determine next phase based on current phase conditions
 		if (currentPhase == 0) {
@@ -70,15 +76,17 @@ float Agent::runEpisode(Environment2D& env, Visualizer& viz, int maxSteps) {
 			if (env.isTaskComplete()) {
 				// Task complete! Reset and start over
 				currentPhase = 0;
+				++episode;
 				env.reset(5);
 				cumulative += 50.0f; // Big reward for success
 				reward = 50.0f;
+				optionReturn = 50.0f;
 			}
 		}
 		
-		planner->updateQ(prevState, optionIdx, reward, env, (int)options.size());
+		planner->updateQ(prevState, optionIdx, optionReturn, env.stateKey(), (int)options.size(), result.steps);
 		cumulative += reward;
-		steps += 20; // approximate steps consumed by option execution
+		steps += std::max(1, result.steps); // a zero-step option still uses up the budget
 		viz.render(env);
 	}
 	return cumulative;
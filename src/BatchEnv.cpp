@@ -0,0 +1,192 @@
+#include "BatchEnv.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Per-action displacement, indexed by Action (Up, Down, Left, Right, None)
+static const std::int32_t kActionDx[8] = {0, 0, -1, 1, 0, 0, 0, 0};
+static const std::int32_t kActionDy[8] = {-1, 1, 0, 0, 0, 0, 0, 0};
+
+// Padding after the grid slab so a 32-bit gather of the last cell stays in bounds
+static const std::size_t kGatherPadding = 3;
+
+BatchEnvironment2D::BatchEnvironment2D(std::size_t count_, int gridW_, int gridH_)
+	: count(count_), gridW(gridW_), gridH(gridH_), cellsPerEnv(static_cast<std::size_t>(gridW_) * gridH_) {
+	robotX.assign(count, 0);
+	robotY.assign(count, 0);
+	targetX.assign(count, 0);
+	targetY.assign(count, 0);
+	objectX.assign(count, 0);
+	objectY.assign(count, 0);
+	carryingBits.assign((count + 63) / 64, 0);
+	grid.assign(count * cellsPerEnv + kGatherPadding, static_cast<std::uint8_t>(CellType::Empty));
+	targetDist.assign(count * cellsPerEnv, DistanceField::kUnreachable);
+}
+
+void BatchEnvironment2D::load(std::size_t i, const Environment2D& env) {
+	assert(i < count);
+	assert(env.getGridWidth() == gridW && env.getGridHeight() == gridH);
+	// batch slots track a single object
+	assert(env.objectCount() + (env.isCarrying() ? 1 : 0) <= 1);
+	const std::vector<CellType>& src = env.getGrid();
+	std::uint8_t* dst = grid.data() + i * cellsPerEnv;
+	for (std::size_t c = 0; c < cellsPerEnv; ++c) {
+		// the robot marker is tracked in robotX/robotY, not in the slab
+		dst[c] = static_cast<std::uint8_t>(src[c] == CellType::Robot ? CellType::Empty : src[c]);
+	}
+	Vec2i r = env.getRobotCell();
+	Vec2i t = env.getTargetCell();
+	Vec2i o = env.getObjectCell();
+	dst[t.y * gridW + t.x] = static_cast<std::uint8_t>(CellType::Target);
+	std::int32_t* dist = targetDist.data() + i * cellsPerEnv;
+	for (int y = 0; y < gridH; ++y) {
+		for (int x = 0; x < gridW; ++x) dist[y * gridW + x] = env.distanceToTarget({x, y});
+	}
+	robotX[i] = r.x; robotY[i] = r.y;
+	targetX[i] = t.x; targetY[i] = t.y;
+	objectX[i] = o.x; objectY[i] = o.y;
+	std::uint64_t bit = std::uint64_t(1) << (i & 63);
+	if (env.isCarrying()) carryingBits[i >> 6] |= bit;
+	else carryingBits[i >> 6] &= ~bit;
+}
+
+void BatchEnvironment2D::stepScalar(std::size_t begin, std::size_t end, const Action* actions, float* rewards) {
+	const std::uint8_t obstacle = static_cast<std::uint8_t>(CellType::Obstacle);
+	for (std::size_t i = begin; i < end; ++i) {
+		const int a = static_cast<int>(actions[i]);
+		const std::int32_t px = robotX[i];
+		const std::int32_t py = robotY[i];
+		std::int32_t nx = std::max(0, std::min(gridW - 1, px + kActionDx[a]));
+		std::int32_t ny = std::max(0, std::min(gridH - 1, py + kActionDy[a]));
+		const std::uint8_t* g = grid.data() + i * cellsPerEnv;
+		if (g[ny * gridW + nx] == obstacle) { nx = px; ny = py; }
+		robotX[i] = nx;
+		robotY[i] = ny;
+
+		bool carrying = isCarrying(i);
+		if (!carrying && nx == objectX[i] && ny == objectY[i]) {
+			setCarrying(i);
+			grid[i * cellsPerEnv + objectY[i] * gridW + objectX[i]] = static_cast<std::uint8_t>(CellType::Empty);
+			carrying = true;
+		}
+
+		if (carrying && nx == targetX[i] && ny == targetY[i]) {
+			rewards[i] = 50.f;
+			continue;
+		}
+		// path distance when both cells have one, Manhattan otherwise (as computeReward)
+		int prevDist = std::abs(px - targetX[i]) + std::abs(py - targetY[i]);
+		int currDist = std::abs(nx - targetX[i]) + std::abs(ny - targetY[i]);
+		const std::int32_t* dist = targetDist.data() + i * cellsPerEnv;
+		const std::int32_t prevPath = dist[py * gridW + px];
+		const std::int32_t currPath = dist[ny * gridW + nx];
+		if (prevPath != DistanceField::kUnreachable && currPath != DistanceField::kUnreachable) {
+			prevDist = prevPath;
+			currDist = currPath;
+		}
+		float r = -0.05f;
+		r += prevDist > currDist ? 1.5f : (prevDist < currDist ? -1.0f : -0.3f);
+		if (currDist <= 3) r += 0.5f;
+		rewards[i] = r;
+	}
+}
+
+void BatchEnvironment2D::step(const Action* actions, float* rewards) {
+	std::size_t i = 0;
+#if defined(__AVX2__)
+	assert(count * cellsPerEnv + kGatherPadding <= 0x7fffffffu);
+	const __m256i dxTable = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kActionDx));
+	const __m256i dyTable = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kActionDy));
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i maxX = _mm256_set1_epi32(gridW - 1);
+	const __m256i maxY = _mm256_set1_epi32(gridH - 1);
+	const __m256i width = _mm256_set1_epi32(gridW);
+	const __m256i byteMask = _mm256_set1_epi32(0xFF);
+	const __m256i obstacle = _mm256_set1_epi32(static_cast<int>(CellType::Obstacle));
+	const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i proximityRange = _mm256_set1_epi32(4);
+	const __m256 stepPenalty = _mm256_set1_ps(-0.05f);
+	const __m256 closer = _mm256_set1_ps(1.5f);
+	const __m256 farther = _mm256_set1_ps(-1.0f);
+	const __m256 same = _mm256_set1_ps(-0.3f);
+	const __m256 proximity = _mm256_set1_ps(0.5f);
+	const __m256 success = _mm256_set1_ps(50.f);
+	const int* gridBase = reinterpret_cast<const int*>(grid.data());
+	const int* distBase = targetDist.data();
+	const __m256i unreachable = _mm256_set1_epi32(DistanceField::kUnreachable);
+
+	// Groups of 8 start at multiples of 8, so their carrying flags are one byte
+	for (; i + 8 <= count; i += 8) {
+		const __m256i act = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(actions + i));
+		const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(robotX.data() + i));
+		const __m256i py = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(robotY.data() + i));
+		const __m256i tx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(targetX.data() + i));
+		const __m256i ty = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(targetY.data() + i));
+		const __m256i ox = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(objectX.data() + i));
+		const __m256i oy = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(objectY.data() + i));
+
+		// move + clamp
+		__m256i nx = _mm256_add_epi32(px, _mm256_permutevar8x32_epi32(dxTable, act));
+		__m256i ny = _mm256_add_epi32(py, _mm256_permutevar8x32_epi32(dyTable, act));
+		nx = _mm256_max_epi32(zero, _mm256_min_epi32(maxX, nx));
+		ny = _mm256_max_epi32(zero, _mm256_min_epi32(maxY, ny));
+
+		// collision: gather the destination cell of every lane from the slab
+		const __m256i envBase = _mm256_mullo_epi32(
+			_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(i)), laneIndex),
+			_mm256_set1_epi32(static_cast<int>(cellsPerEnv)));
+		const __m256i prevIdx = _mm256_add_epi32(envBase, _mm256_add_epi32(_mm256_mullo_epi32(py, width), px));
+		const __m256i cellIdx = _mm256_add_epi32(envBase, _mm256_add_epi32(_mm256_mullo_epi32(ny, width), nx));
+		const __m256i cell = _mm256_and_si256(_mm256_i32gather_epi32(gridBase, cellIdx, 1), byteMask);
+		const __m256i blocked = _mm256_cmpeq_epi32(cell, obstacle);
+		nx = _mm256_blendv_epi8(nx, px, blocked);
+		ny = _mm256_blendv_epi8(ny, py, blocked);
+		const __m256i currIdx = _mm256_blendv_epi8(cellIdx, prevIdx, blocked);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(robotX.data() + i), nx);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(robotY.data() + i), ny);
+
+		// pickup
+		const unsigned carryByte = static_cast<unsigned>(carryingBits[i >> 6] >> (i & 63)) & 0xFFu;
+		__m256i carry = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(carryByte)), laneBits), laneBits);
+		const __m256i onObject = _mm256_and_si256(_mm256_cmpeq_epi32(nx, ox), _mm256_cmpeq_epi32(ny, oy));
+		const __m256i pickup = _mm256_andnot_si256(carry, onObject);
+		unsigned pickMask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(pickup)));
+		if (pickMask) {
+			carryingBits[i >> 6] |= static_cast<std::uint64_t>(pickMask) << (i & 63);
+			for (unsigned lane = 0; lane < 8; ++lane) {
+				if (!(pickMask & (1u << lane))) continue;
+				std::size_t e = i + lane;
+				grid[e * cellsPerEnv + objectY[e] * gridW + objectX[e]] = static_cast<std::uint8_t>(CellType::Empty);
+			}
+			carry = _mm256_or_si256(carry, pickup);
+		}
+
+		// reward
+		// path distance when both cells have one, Manhattan otherwise
+		const __m256i prevPath = _mm256_i32gather_epi32(distBase, prevIdx, 4);
+		const __m256i currPath = _mm256_i32gather_epi32(distBase, currIdx, 4);
+		const __m256i noPath = _mm256_or_si256(_mm256_cmpeq_epi32(prevPath, unreachable), _mm256_cmpeq_epi32(currPath, unreachable));
+		const __m256i prevManhattan = _mm256_add_epi32(_mm256_abs_epi32(_mm256_sub_epi32(px, tx)), _mm256_abs_epi32(_mm256_sub_epi32(py, ty)));
+		const __m256i currManhattan = _mm256_add_epi32(_mm256_abs_epi32(_mm256_sub_epi32(nx, tx)), _mm256_abs_epi32(_mm256_sub_epi32(ny, ty)));
+		const __m256i prevDist = _mm256_blendv_epi8(prevPath, prevManhattan, noPath);
+		const __m256i currDist = _mm256_blendv_epi8(currPath, currManhattan, noPath);
+		const __m256 gotCloser = _mm256_castsi256_ps(_mm256_cmpgt_epi32(prevDist, currDist));
+		const __m256 gotFarther = _mm256_castsi256_ps(_mm256_cmpgt_epi32(currDist, prevDist));
+		__m256 progress = _mm256_blendv_ps(same, farther, gotFarther);
+		progress = _mm256_blendv_ps(progress, closer, gotCloser);
+		__m256 r = _mm256_add_ps(stepPenalty, progress);
+		const __m256 near = _mm256_castsi256_ps(_mm256_cmpgt_epi32(proximityRange, currDist));
+		r = _mm256_add_ps(r, _mm256_and_ps(near, proximity));
+		const __m256i atTarget = _mm256_and_si256(_mm256_cmpeq_epi32(nx, tx), _mm256_cmpeq_epi32(ny, ty));
+		r = _mm256_blendv_ps(r, success, _mm256_castsi256_ps(_mm256_and_si256(carry, atTarget)));
+		_mm256_storeu_ps(rewards + i, r);
+	}
+#endif
+	stepScalar(i, count, actions, rewards);
+}
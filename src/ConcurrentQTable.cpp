@@ -0,0 +1,157 @@
+#include "ConcurrentQTable.hpp"
+#include "QTable.hpp"
+
+#include <algorithm>
+
+namespace {
+std::atomic<std::uint64_t> nextInstance{1};
+
+// Last table this thread updated in ThreadDeltas mode and its delta there, so
+// the common case skips the registry lock. Keyed by instance id rather than
+// address, which a later table could reuse.
+struct DeltaCache {
+	std::uint64_t owner = 0;
+	void* delta = nullptr;
+};
+thread_local DeltaCache deltaCache;
+}
+
+ConcurrentQTable::ConcurrentQTable(int numStates, int numActions, QConcurrency mode, int mergeInterval)
+	: states(numStates < 0 ? 0 : numStates), actions(numActions < 0 ? 0 : numActions), concurrency(mode),
+	  mergeEvery(mergeInterval < 1 ? 1 : mergeInterval), instance(nextInstance.fetch_add(1, std::memory_order_relaxed)) {
+	const std::size_t n = static_cast<std::size_t>(states) * actions;
+	values.reset(new std::atomic<float>[n]);
+	for (std::size_t i = 0; i < n; ++i) values[i].store(0.0f, std::memory_order_relaxed);
+	touchedRows.reset(new std::atomic<std::uint8_t>[static_cast<std::size_t>(states)]);
+	for (int s = 0; s < states; ++s) touchedRows[s].store(0, std::memory_order_relaxed);
+	if (concurrency == QConcurrency::ShardedLocks) shards.reset(new Shard[kShards]);
+}
+
+ConcurrentQTable::~ConcurrentQTable() = default;
+
+float ConcurrentQTable::sharedMax(int state) {
+	if (actions == 0) return 0.0f;
+	float best = get(state, 0);
+	for (int a = 1; a < actions; ++a) best = std::max(best, get(state, a));
+	return best;
+}
+
+ConcurrentQTable::Delta& ConcurrentQTable::localDelta() {
+	if (deltaCache.owner == instance) return *static_cast<Delta*>(deltaCache.delta);
+	std::lock_guard<std::mutex> lock(deltaMutex);
+	const std::thread::id self = std::this_thread::get_id();
+	Delta* d = nullptr;
+	for (std::size_t i = 0; i < deltaOwners.size(); ++i) {
+		if (deltaOwners[i] == self) d = deltas[i].get();
+	}
+	if (!d) {
+		deltas.emplace_back(new Delta);
+		deltaOwners.push_back(self);
+		d = deltas.back().get();
+		d->values.assign(static_cast<std::size_t>(states) * actions, 0.0f);
+		d->dirty.reserve(static_cast<std::size_t>(mergeEvery));
+	}
+	deltaCache.owner = instance;
+	deltaCache.delta = d;
+	return *d;
+}
+
+void ConcurrentQTable::merge(Delta& d) {
+	// callers hold deltaMutex, the only writer of shared values in this mode
+	for (std::uint32_t i : d.dirty) {
+		if (d.values[i] == 0.0f) continue; // listed twice, already merged
+		values[i].store(values[i].load(std::memory_order_relaxed) + d.values[i], std::memory_order_relaxed);
+		d.values[i] = 0.0f;
+	}
+	d.dirty.clear();
+}
+
+float ConcurrentQTable::maxValue(int state) {
+	if (concurrency != QConcurrency::ThreadDeltas || actions == 0) return sharedMax(state);
+	const float* dq = localDelta().values.data() + static_cast<std::size_t>(state) * actions;
+	float best = get(state, 0) + dq[0];
+	for (int a = 1; a < actions; ++a) best = std::max(best, get(state, a) + dq[a]);
+	return best;
+}
+
+int ConcurrentQTable::argmax(int state) {
+	const float* dq = nullptr;
+	if (concurrency == QConcurrency::ThreadDeltas) dq = localDelta().values.data() + static_cast<std::size_t>(state) * actions;
+	int best = 0;
+	float bestValue = 0.0f;
+	for (int a = 0; a < actions; ++a) {
+		const float v = get(state, a) + (dq ? dq[a] : 0.0f);
+		if (a == 0 || v > bestValue) {
+			best = a;
+			bestValue = v;
+		}
+	}
+	return best;
+}
+
+float ConcurrentQTable::backup(int state, int action, float reward, int next, float alpha, float discount) {
+	switch (concurrency) {
+	case QConcurrency::None:
+	case QConcurrency::Hogwild: {
+		// unsynchronized read-modify-write: a racing update of the same entry may be overwritten
+		const float target = reward + discount * sharedMax(next);
+		std::atomic<float>& q = at(state, action);
+		const float v = q.load(std::memory_order_relaxed);
+		q.store(v + alpha * (target - v), std::memory_order_relaxed);
+		return target - v;
+	}
+	case QConcurrency::ShardedLocks: {
+		std::lock_guard<std::mutex> lock(shards[static_cast<std::size_t>(state) % kShards].mutex);
+		const float target = reward + discount * sharedMax(next);
+		std::atomic<float>& q = at(state, action);
+		const float v = q.load(std::memory_order_relaxed);
+		q.store(v + alpha * (target - v), std::memory_order_relaxed);
+		return target - v;
+	}
+	case QConcurrency::ThreadDeltas: {
+		Delta& d = localDelta();
+		const std::uint32_t i = static_cast<std::uint32_t>(static_cast<std::size_t>(state) * actions + action);
+		const float target = reward + discount * maxValue(next);
+		const float td = target - (get(state, action) + d.values[i]);
+		d.values[i] += alpha * td;
+		d.dirty.push_back(i);
+		if (d.dirty.size() >= static_cast<std::size_t>(mergeEvery)) {
+			std::lock_guard<std::mutex> lock(deltaMutex);
+			merge(d);
+		}
+		return td;
+	}
+	}
+	return 0.0f;
+}
+
+void ConcurrentQTable::flush() {
+	std::lock_guard<std::mutex> lock(deltaMutex);
+	for (auto& d : deltas) merge(*d);
+}
+
+void ConcurrentQTable::snapshot(QTable& out) {
+	flush();
+	out.reset(states, actions);
+	for (int s = 0; s < states; ++s) {
+		float* row = out.row(s);
+		for (int a = 0; a < actions; ++a) row[a] = get(s, a);
+		if (touchedRows[s].load(std::memory_order_relaxed)) out.touch(s);
+	}
+}
+
+void ConcurrentQTable::load(const QTable& in) {
+	std::lock_guard<std::mutex> lock(deltaMutex);
+	for (auto& d : deltas) {
+		std::fill(d->values.begin(), d->values.end(), 0.0f);
+		d->dirty.clear();
+	}
+	const int rows = std::min(states, in.numStates());
+	const int cols = std::min(actions, in.numActions());
+	for (int s = 0; s < states; ++s) {
+		for (int a = 0; a < actions; ++a) {
+			at(s, a).store(s < rows && a < cols ? in.at(s, a) : 0.0f, std::memory_order_relaxed);
+		}
+		touchedRows[s].store(s < rows && in.touched(s) ? 1 : 0, std::memory_order_relaxed);
+	}
+}
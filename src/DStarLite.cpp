@@ -0,0 +1,219 @@
+#include "DStarLite.hpp"
+#include "Env.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+static const int dx[4] = {1, -1, 0, 0};
+static const int dy[4] = {0, 0, 1, -1};
+
+void DStarLite::setObstacleCost(int c) {
+	clearCost = c < 0 ? 0 : c;
+	invalidate();
+}
+
+std::size_t DStarLite::sizeBytes() const {
+	return (g.capacity() + rhs.capacity()) * sizeof(std::int32_t) + (blocked.capacity() + open.capacity()) +
+		openKey.capacity() * sizeof(Key) + heap.capacity() * sizeof(HeapEntry);
+}
+
+bool DStarLite::plan(const Environment2D& env, const Vec2i& start, const Vec2i& goal) {
+	expanded = 0;
+	startCost = 0;
+	const int gw = env.getGridWidth();
+	const int gh = env.getGridHeight();
+	if (start.x < 0 || start.x >= gw || start.y < 0 || start.y >= gh) return false;
+	if (goal.x < 0 || goal.x >= gw || goal.y < 0 || goal.y >= gh) return false;
+
+	const int s = start.y * gw + start.x;
+	const int t = goal.y * gw + goal.x;
+	startIndex = s;
+	if (t != goalIndex || gw != w || gh != h || env.changeEpoch() != epoch || logPos > env.cellChanges().size()) {
+		w = gw;
+		h = gh;
+		restart(env, t);
+	} else {
+		applyChanges(env);
+	}
+	if (s == t) return true;
+	computeShortestPath();
+	if (g[s] >= kInf) return false;
+	startCost = g[s];
+	return true;
+}
+
+void DStarLite::restart(const Environment2D& env, int goal) {
+	const std::size_t cells = static_cast<std::size_t>(w) * h;
+	g.assign(cells, kInf);
+	rhs.assign(cells, kInf);
+	open.assign(cells, 0);
+	openKey.resize(cells);
+	blocked.resize(cells);
+	const ObstacleBitboard& obstacles = env.getObstacles();
+	for (int y = 0; y < h; ++y) {
+		for (int x = 0; x < w; ++x) blocked[y * w + x] = obstacles.test(x, y) ? 1 : 0;
+	}
+	heap.clear();
+	km = 0;
+	goalIndex = goal;
+	lastStart = startIndex;
+	epoch = env.changeEpoch();
+	logPos = env.cellChanges().size();
+	rhs[goal] = 0;
+	push(goal, calculateKey(goal));
+}
+
+void DStarLite::applyChanges(const Environment2D& env) {
+	const std::vector<CellChange>& log = env.cellChanges();
+	const ObstacleBitboard& obstacles = env.getObstacles();
+	bool changed = false;
+	for (; logPos < log.size(); ++logPos) {
+		// most entries are robot moves; only obstacle flips change costs, and the
+		// current bitboard collapses repeated writes to one cell
+		const int v = log[logPos].index;
+		const std::uint8_t now = obstacles.test(v % w, v / w) ? 1 : 0;
+		if (now == blocked[v]) continue;
+		if (!changed) {
+			// lower bound on how far every queued key is now from the moved start
+			km += heuristic(lastStart, startIndex);
+			lastStart = startIndex;
+			changed = true;
+		}
+		blocked[v] = now;
+		// only edges into v changed cost, so only its predecessors may change
+		updatePredecessors(v);
+	}
+}
+
+void DStarLite::computeShortestPath() {
+	while (topLive()) {
+		const HeapEntry top = heap.front();
+		if (!(top.key < calculateKey(startIndex)) && rhs[startIndex] == g[startIndex]) break;
+		std::pop_heap(heap.begin(), heap.end(), heapAfter);
+		heap.pop_back();
+		const int u = top.cell;
+		const Key fresh = calculateKey(u);
+		if (top.key < fresh) {
+			push(u, fresh);
+			continue;
+		}
+		open[u] = 0;
+		++expanded;
+		if (g[u] > rhs[u]) {
+			g[u] = rhs[u];
+		} else {
+			g[u] = kInf;
+			updateVertex(u);
+		}
+		updatePredecessors(u);
+	}
+}
+
+void DStarLite::updateVertex(int u) {
+	if (u != goalIndex) {
+		const int best = bestSuccessor(u);
+		rhs[u] = best < 0 ? kInf : std::min(kInf, enterCost(best) + g[best]);
+	}
+	if (g[u] != rhs[u]) push(u, calculateKey(u));
+	else open[u] = 0;
+}
+
+void DStarLite::updatePredecessors(int u) {
+	// every in-grid neighbor can step into u (the search rejects u itself if it
+	// is a boundary cell)
+	const int x = u % w;
+	const int y = u / w;
+	for (int k = 0; k < 4; ++k) {
+		const int nx = x + dx[k];
+		const int ny = y + dy[k];
+		if (nx < 0 || nx >= w || ny < 0 || ny >= h) continue;
+		updateVertex(ny * w + nx);
+	}
+}
+
+DStarLite::Key DStarLite::calculateKey(int u) const {
+	const std::int32_t m = std::min(g[u], rhs[u]);
+	return {m + heuristic(startIndex, u) + km, m};
+}
+
+int DStarLite::heuristic(int a, int b) const {
+	return std::abs(a % w - b % w) + std::abs(a / w - b / w);
+}
+
+bool DStarLite::enterable(int u) const {
+	const int x = u % w;
+	const int y = u / w;
+	return x > 0 && x < w - 1 && y > 0 && y < h - 1;
+}
+
+int DStarLite::bestSuccessor(int u) const {
+	// ties keep the first neighbor in right, left, down, up order
+	const int x = u % w;
+	const int y = u / w;
+	int best = -1;
+	std::int32_t bestCost = kInf;
+	for (int k = 0; k < 4; ++k) {
+		const int nx = x + dx[k];
+		const int ny = y + dy[k];
+		if (nx < 0 || nx >= w || ny < 0 || ny >= h) continue;
+		const int v = ny * w + nx;
+		if (!enterable(v) || g[v] >= kInf) continue;
+		const std::int32_t c = enterCost(v) + g[v];
+		if (c < bestCost) {
+			bestCost = c;
+			best = v;
+		}
+	}
+	return best;
+}
+
+bool DStarLite::heapAfter(const HeapEntry& a, const HeapEntry& b) {
+	return b.key < a.key;
+}
+
+void DStarLite::push(int u, const Key& k) {
+	open[u] = 1;
+	openKey[u] = k;
+	heap.push_back({k, u});
+	std::push_heap(heap.begin(), heap.end(), heapAfter);
+	// drop superseded entries before they outnumber the cells
+	if (heap.size() > 4 * open.size()) {
+		heap.erase(std::remove_if(heap.begin(), heap.end(), [this](const HeapEntry& e) {
+			return !open[e.cell] || !(openKey[e.cell] == e.key);
+		}), heap.end());
+		std::make_heap(heap.begin(), heap.end(), heapAfter);
+	}
+}
+
+bool DStarLite::topLive() {
+	while (!heap.empty()) {
+		const HeapEntry& e = heap.front();
+		if (open[e.cell] && openKey[e.cell] == e.key) return true;
+		std::pop_heap(heap.begin(), heap.end(), heapAfter);
+		heap.pop_back();
+	}
+	return false;
+}
+
+bool DStarLite::nextCell(Vec2i& out) const {
+	if (goalIndex < 0 || startIndex == goalIndex || g[startIndex] >= kInf) return false;
+	const int v = bestSuccessor(startIndex);
+	if (v < 0) return false;
+	out = {v % w, v / w};
+	return true;
+}
+
+void DStarLite::extractPath(ClearingPlan& out) const {
+	out.path.clear();
+	out.clears.clear();
+	out.cost = 0;
+	if (goalIndex < 0 || g[startIndex] >= kInf) return;
+	out.cost = g[startIndex];
+	const std::size_t limit = g.size();
+	for (int c = startIndex; c != goalIndex && out.path.size() < limit;) {
+		c = bestSuccessor(c);
+		if (c < 0) break;
+		out.path.push_back({c % w, c / w});
+		if (blocked[c]) out.clears.push_back(out.path.back());
+	}
+}
@@ -0,0 +1,224 @@
+#include "DistanceField.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const int dx[4] = {1, -1, 0, 0};
+static const int dy[4] = {0, 0, 1, -1};
+
+static inline int ctz64(std::uint64_t v) {
+#if defined(_MSC_VER)
+	unsigned long i;
+	_BitScanForward64(&i, v);
+	return static_cast<int>(i);
+#else
+	return __builtin_ctzll(v);
+#endif
+}
+
+static inline int popcount64(std::uint64_t v) {
+#if defined(_MSC_VER)
+	return static_cast<int>(__popcnt64(v));
+#else
+	return __builtin_popcountll(v);
+#endif
+}
+
+void DistanceField::build(const ObstacleBitboard& obstacles, int width, int height, const std::vector<Vec2i>& sources) {
+	w = width;
+	h = height;
+	dist.assign(static_cast<std::size_t>(w) * h, kUnreachable);
+	const int wordsPerRow = (w + 63) / 64;
+	const bool wide = wordsPerRow > 64;
+	stride = ((wordsPerRow + 3) & ~3) + 2;
+	const std::size_t words = static_cast<std::size_t>(stride) * h;
+	passableBits.assign(words, 0);
+	visitedBits.assign(words, 0);
+	frontierBits.assign(words, 0);
+	nextBits.assign(words, 0);
+	frontierWords.assign(h, 0);
+	nextWords.assign(h, 0);
+	frontierSpill.assign(h, 0);
+	nextSpill.assign(h, 0);
+
+	// interior columns 1 .. w-2 of every interior row, minus obstacles
+	for (int y = 1; y < h - 1; ++y) {
+		std::uint64_t* row = passableBits.data() + static_cast<std::size_t>(y) * stride + 1;
+		for (int k = 0; k < wordsPerRow; ++k) {
+			std::uint64_t interior = ~std::uint64_t(0);
+			if (k == 0) interior &= ~std::uint64_t(1);
+			const int past = w - 1 - 64 * k; // first non-interior column at or after this word
+			if (past < 64) interior &= past <= 0 ? 0 : (std::uint64_t(1) << past) - 1;
+			row[k] = ~obstacles.rowWord(y, k) & interior;
+		}
+	}
+
+	int lo = h;
+	int hi = -1;
+	for (const Vec2i& s : sources) {
+		if (!passable(obstacles, s.x, s.y)) continue;
+		const int k = s.x >> 6;
+		const std::size_t i = static_cast<std::size_t>(s.y) * stride + 1 + k;
+		const std::uint64_t b = std::uint64_t(1) << (s.x & 63);
+		dist[s.y * w + s.x] = 0;
+		visitedBits[i] |= b;
+		frontierBits[i] |= b;
+		frontierWords[s.y] |= std::uint64_t(1) << (wide ? 0 : k);
+		if (!wide && (s.x & 63) == 0 && k > 0) frontierSpill[s.y] |= std::uint64_t(1) << (k - 1);
+		if (!wide && (s.x & 63) == 63 && k + 1 < wordsPerRow) frontierSpill[s.y] |= std::uint64_t(1) << (k + 1);
+		lo = std::min(lo, s.y);
+		hi = std::max(hi, s.y);
+	}
+
+	for (std::int32_t level = 1; lo <= hi; ++level) {
+		int nextLo = h;
+		int nextHi = -1;
+		expandLevel(std::max(1, lo - 1), std::min(h - 2, hi + 1), wordsPerRow, level, nextLo, nextHi);
+		// zero the old frontier so it can take the next level's output
+		for (int y = lo; y <= hi; ++y) {
+			std::uint64_t* row = frontierBits.data() + static_cast<std::size_t>(y) * stride + 1;
+			if (wide) {
+				if (frontierWords[y]) std::fill(row, row + wordsPerRow, 0);
+			} else {
+				for (std::uint64_t m = frontierWords[y]; m; m &= m - 1) row[ctz64(m)] = 0;
+			}
+			frontierWords[y] = 0;
+			frontierSpill[y] = 0;
+		}
+		frontierBits.swap(nextBits);
+		frontierWords.swap(nextWords);
+		frontierSpill.swap(nextSpill);
+		lo = nextLo;
+		hi = nextHi;
+	}
+}
+
+void DistanceField::expandLevel(int lo, int hi, int wordsPerRow, std::int32_t level, int& nextLo, int& nextHi) {
+	const bool wide = wordsPerRow > 64;
+	const std::uint64_t rowMask = wordsPerRow >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << wordsPerRow) - 1;
+	for (int y = lo; y <= hi; ++y) {
+		std::uint64_t candidates = frontierWords[y - 1] | frontierWords[y] | frontierWords[y + 1] | frontierSpill[y];
+		if (!candidates) continue;
+		const std::size_t base = static_cast<std::size_t>(y) * stride + 1;
+		const std::uint64_t* f = frontierBits.data() + base;
+		const std::uint64_t* up = f - stride;
+		const std::uint64_t* down = f + stride;
+		const std::uint64_t* pass = passableBits.data() + base;
+		std::uint64_t* visited = visitedBits.data() + base;
+		std::uint64_t* out = nextBits.data() + base;
+		std::int32_t* distRow = dist.data() + static_cast<std::size_t>(y) * w;
+		std::uint64_t reached = 0;
+		std::uint64_t spill = 0;
+
+		auto markReached = [&](int k, std::uint64_t fresh) {
+			if (wide) {
+				reached = 1;
+				return;
+			}
+			reached |= std::uint64_t(1) << k;
+			if ((fresh & 1) && k > 0) spill |= std::uint64_t(1) << (k - 1);
+			if (fresh >> 63) spill |= std::uint64_t(1) << (k + 1);
+		};
+		// one word of the next level: the frontier shifted one cell each way,
+		// plus the rows above and below, limited to unvisited passable cells
+		auto expandWord = [&](int k) {
+			const std::uint64_t cur = f[k];
+			const std::uint64_t grow = cur | (cur << 1) | (cur >> 1) | (f[k - 1] >> 63) | (f[k + 1] << 63) | up[k] | down[k];
+			const std::uint64_t fresh = grow & pass[k] & ~visited[k];
+			out[k] = fresh;
+			if (!fresh) return;
+			visited[k] |= fresh;
+			markReached(k, fresh);
+			for (std::uint64_t bits = fresh; bits; bits &= bits - 1) distRow[64 * k + ctz64(bits)] = level;
+		};
+
+		if (!wide && popcount64(candidates) * 2 <= wordsPerRow) {
+			// sparse row: only words under a frontier word (this row or the ones
+			// above and below) or reached by a spilling edge bit can change
+			for (; candidates; candidates &= candidates - 1) expandWord(ctz64(candidates));
+		} else {
+			int k = 0;
+#if defined(__AVX2__)
+			for (; k < wordsPerRow; k += 4) {
+				const __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + k));
+				const __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + k - 1));
+				const __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + k + 1));
+				__m256i grow = _mm256_or_si256(cur, _mm256_slli_epi64(cur, 1));
+				grow = _mm256_or_si256(grow, _mm256_srli_epi64(cur, 1));
+				grow = _mm256_or_si256(grow, _mm256_srli_epi64(left, 63));
+				grow = _mm256_or_si256(grow, _mm256_slli_epi64(right, 63));
+				grow = _mm256_or_si256(grow, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(up + k)));
+				grow = _mm256_or_si256(grow, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(down + k)));
+				const __m256i vis = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(visited + k));
+				const __m256i fresh = _mm256_andnot_si256(vis, _mm256_and_si256(grow,
+					_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pass + k))));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), fresh);
+				if (_mm256_testz_si256(fresh, fresh)) continue;
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(visited + k), _mm256_or_si256(vis, fresh));
+				// the padding words past the row are never passable, so j stays in range
+				for (int j = k; j < k + 4; ++j) {
+					if (!out[j]) continue;
+					markReached(j, out[j]);
+					for (std::uint64_t bits = out[j]; bits; bits &= bits - 1) distRow[64 * j + ctz64(bits)] = level;
+				}
+			}
+#endif
+			for (; k < wordsPerRow; ++k) expandWord(k);
+		}
+
+		nextWords[y] = reached;
+		nextSpill[y] = spill & rowMask;
+		if (reached) {
+			nextLo = std::min(nextLo, y);
+			nextHi = std::max(nextHi, y);
+		}
+	}
+}
+
+void DistanceField::cellCleared(const ObstacleBitboard& obstacles, const Vec2i& cell) {
+	if (dist.empty() || !passable(obstacles, cell.x, cell.y)) return;
+	int i = cell.y * w + cell.x;
+	std::int32_t best = dist[i];
+	for (int k = 0; k < 4; ++k) {
+		int nx = cell.x + dx[k];
+		int ny = cell.y + dy[k];
+		if (!passable(obstacles, nx, ny)) continue;
+		std::int32_t d = dist[ny * w + nx];
+		if (d != kUnreachable && d + 1 < best) best = d + 1;
+	}
+	if (best == dist[i]) return;
+	dist[i] = best;
+	queue.clear();
+	queue.push_back(i);
+	propagate(obstacles, 0);
+}
+
+void DistanceField::invalidate() {
+	dist.clear();
+}
+
+// FIFO relaxation from the queued cells. Starting from cells of equal distance
+// this is plain BFS, so each cell is settled the first time it is improved.
+void DistanceField::propagate(const ObstacleBitboard& obstacles, std::size_t head) {
+	while (head < queue.size()) {
+		int cur = queue[head++];
+		int cx = cur % w;
+		int cy = cur / w;
+		std::int32_t nd = dist[cur] + 1;
+		for (int k = 0; k < 4; ++k) {
+			int nx = cx + dx[k];
+			int ny = cy + dy[k];
+			if (!passable(obstacles, nx, ny)) continue;
+			int ni = ny * w + nx;
+			if (nd >= dist[ni]) continue;
+			dist[ni] = nd;
+			queue.push_back(ni);
+		}
+	}
+}
@@ -1,51 +1,68 @@
 #include "Env.hpp"
 #include "utils.h"
+#include "Log.hpp"
+#include "Scenario.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <random>
 #include <cmath>
-#include <iostream>
 
-static float length(const sf::Vector2f& v) {
+static float length(const Vec2f& v) {
 	return std::sqrt(v.x * v.x + v.y * v.y);
 }
 
-static sf::Vector2f normalize(const sf::Vector2f& v) {
+static Vec2f normalize(const Vec2f& v) {
 	float len = length(v);
 	if (len <= 1e-5f) return {0.f, 0.f};
 	return {v.x / len, v.y / len};
 }
 
-Environment2D::Environment2D(unsigned int width_, unsigned int height_)
-	: width(width_), height(height_), robotTarget(width_ * 0.5f, height_ * 0.5f), targetRegion(width_ * 0.8f, height_ * 0.5f), targetRadius(30.f) {
+Environment2D::Environment2D(unsigned int width_, unsigned int height_, const EnvConfig& cfg)
+	: config(cfg), width(width_), height(height_), robotTarget(width_ * 0.5f, height_ * 0.5f), targetRegion(width_ * 0.8f, height_ * 0.5f), targetRadius(30.f) {
 	robot.radius = 12.f;
 	robot.position = {width * 0.2f, height * 0.5f};
 	robot.velocity = {0.f, 0.f};
 	robot.maxSpeed = 150.f;
-	gridW = GRID_WIDTH;
-	gridH = GRID_HEIGHT;
+	config.gridWidth = std::max(config.gridWidth, MIN_GRID_WIDTH);
+	config.gridHeight = std::max(config.gridHeight, MIN_GRID_HEIGHT);
+	config.obstacleDensity = std::max(config.obstacleDensity, 0.f);
+	config.clearCost = std::max(config.clearCost, 0);
+	planner.setObstacleCost(config.clearCost);
+	gridW = config.gridWidth;
+	gridH = config.gridHeight;
 	grid.assign(gridW * gridH, CellType::Empty);
+	obstacles.resize(gridW, gridH);
 	robotCell = {1, gridH / 2};
 	targetCell = {gridW - 2, gridH / 2};
 	objectCell = {gridW / 3, gridH / 2};
 	carrying = false;
+	objectIndex.reset(gridW, gridH, 1);
+	std::random_device rd;
+	rngSeed = (static_cast<std::uint64_t>(rd()) << 32) | rd();
 }
 
 void Environment2D::reset(unsigned int numObjects) {
-	(void)numObjects;
+	const unsigned int objectTotal = std::max(1u, numObjects);
 	// Reset robot position (always start at left side)
 	robotCell = {1, gridH / 2};
 	
 	// Randomize target position (but keep it on the right side)
 	grid.assign(gridW * gridH, CellType::Empty);
-	std::mt19937 rng(std::random_device{}());
-	std::uniform_int_distribution<int> targetX(gridW - 5, gridW - 2); // Right side
-	std::uniform_int_distribution<int> targetY(2, gridH - 3); // Avoid edges
-	targetCell = {targetX(rng), targetY(rng)};
+	obstacles.clear();
+	objectIndex.reset(gridW, gridH, objectTotal);
+	// Re-key the persistent engine: one independent stream per (episode, reset)
+	std::uint64_t stream = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(currentEpisode)) << 32) |
+		static_cast<std::uint32_t>(resetsInEpisode++);
+	rng.seed(rngSeed, stream);
+	int tx = rng.uniformInt(gridW - 5, gridW - 2); // Right side
+	int ty = rng.uniformInt(2, gridH - 3); // Avoid edges
+	targetCell = {tx, ty};
 
 	// Place a single object somewhere else (left/middle side)
-	std::uniform_int_distribution<int> objX(2, std::max(2, gridW/2 - 2));
-	std::uniform_int_distribution<int> objY(2, gridH - 3);
-	objectCell = {objX(rng), objY(rng)};
+	int ox = rng.uniformInt(2, std::max(2, gridW/2 - 2));
+	int oy = rng.uniformInt(2, gridH - 3);
+	objectCell = {ox, oy};
 
 	// If we've passed episode 10, place the object on the same horizontal line as the target
 	// (i.e., match the object's y to the target's y) to make the task easier/consistent
@@ -61,74 +78,236 @@ void Environment2D::reset(unsigned int numObjects) {
 	carrying = false;
 	
 	// Generate obstacles
-	std::uniform_int_distribution<int> ox(1, gridW - 2);
-	std::uniform_int_distribution<int> oy(1, gridH - 2);
-
-	for (int i = 0; i < gridW * gridH / 2; ++i) {
-		sf::Vector2i c{ox(rng), oy(rng)};
+	const long long obstacleAttempts = static_cast<long long>(static_cast<double>(gridW) * gridH * config.obstacleDensity);
+	for (long long i = 0; i < obstacleAttempts; ++i) {
+		Vec2i c{rng.uniformInt(1, gridW - 2), rng.uniformInt(1, gridH - 2)};
 		if (c == robotCell || c == targetCell) continue;
 		// avoid placing obstacles on the object cell
 		if (c == objectCell) continue;
-		grid[idx(c.x, c.y)] = CellType::Obstacle;
+		setCell(c, CellType::Obstacle);
+	}
+	setCell(targetCell, CellType::Target);
+	setCell(objectCell, CellType::Object);
+	setCell(robotCell, CellType::Robot);
+	objectIndex.insert(objectCell);
+
+	// Further objects go on free interior cells. A single-object reset draws
+	// nothing here, so its maps are unchanged by the object count.
+	unsigned int placed = 1;
+	for (unsigned int attempt = 0; placed < objectTotal && attempt < 16 * objectTotal; ++attempt) {
+		Vec2i c{rng.uniformInt(1, gridW - 2), rng.uniformInt(1, gridH - 2)};
+		if (grid[idx(c.x, c.y)] != CellType::Empty) continue;
+		setCell(c, CellType::Object);
+		objectIndex.insert(c);
+		++placed;
 	}
-	grid[idx(targetCell.x, targetCell.y)] = CellType::Target;
-	grid[idx(objectCell.x, objectCell.y)] = CellType::Object;
-	grid[idx(robotCell.x, robotCell.y)] = CellType::Robot;
 
 	// Debug: print robot and target positions
-	std::cout << "Reset: Robot at (" << robotCell.x << "," << robotCell.y << "), Target at (" << targetCell.x << "," << targetCell.y << ")" << std::endl;
+	O3F_LOG_DEBUG("Reset: Robot at (" << robotCell.x << "," << robotCell.y << "), Target at (" << targetCell.x << "," << targetCell.y << ")");
+
+	finishReset();
+}
+
+bool Environment2D::attachScenarios(const ScenarioCorpus* corpus) {
+	if (corpus && (!corpus->isOpen() || corpus->gridWidth() != gridW || corpus->gridHeight() != gridH)) return false;
+	scenarios = corpus;
+	return true;
+}
+
+bool Environment2D::resetFromScenario(std::size_t i) {
+	if (!scenarios || i >= scenarios->size()) return false;
+	const ScenarioRecord& rec = scenarios->record(i);
+	const Vec2i robotAt{rec.robotX, rec.robotY};
+	const Vec2i targetAt{rec.targetX, rec.targetY};
+	const Vec2i objectAt{rec.objectX, rec.objectY};
+	auto interior = [&](const Vec2i& c) { return c.x > 0 && c.x < gridW - 1 && c.y > 0 && c.y < gridH - 1; };
+	if (!interior(robotAt) || !interior(targetAt) || !interior(objectAt)) return false;
+
+	grid.assign(gridW * gridH, CellType::Empty);
+	obstacles.clear();
+	objectIndex.reset(gridW, gridH, 1);
+	// Only non-zero bitmap bytes cost anything beyond the scan
+	const std::uint8_t* bits = scenarios->obstacleBits(i);
+	const int cells = gridW * gridH;
+	for (int byte = 0; byte < (cells + 7) / 8; ++byte) {
+		const unsigned b = bits[byte];
+		if (!b) continue;
+		for (int k = 0; k < 8; ++k) {
+			int cell = byte * 8 + k;
+			if (((b >> k) & 1u) && cell < cells) writeCell(cell, CellType::Obstacle);
+		}
+	}
+	robotCell = robotAt;
+	targetCell = targetAt;
+	objectCell = objectAt;
+	carrying = false;
+	writeCell(idx(targetCell.x, targetCell.y), CellType::Target);
+	writeCell(idx(objectCell.x, objectCell.y), CellType::Object);
+	writeCell(idx(robotCell.x, robotCell.y), CellType::Robot);
+	objectIndex.insert(objectCell);
+
+	O3F_LOG_DEBUG("Reset from scenario " << i << ": Robot at (" << robotCell.x << "," << robotCell.y << "), Target at (" << targetCell.x << "," << targetCell.y << ")");
+
+	finishReset();
+	return true;
+}
 
+void Environment2D::finishReset() {
 	// sync continuous space visualization targets
-	robot.position = {robotCell.x * CELL_SIZE + CELL_SIZE * 0.5f, robotCell.y * CELL_SIZE + CELL_SIZE * 0.5f};
+	syncRobotPosition();
 	robot.velocity = {0.f, 0.f};
-	robotTarget = robot.position;
-	targetRegion = {targetCell.x * CELL_SIZE + CELL_SIZE * 0.5f, targetCell.y * CELL_SIZE + CELL_SIZE * 0.5f};
+	const float cs = config.cellSize;
+	targetRegion = {targetCell.x * cs + cs * 0.5f, targetCell.y * cs + cs * 0.5f};
 	objects.clear();
+	// map generation is not undoable; marks taken before this reset are invalid
+	undoLog.clear();
+	objectLog.clear();
+	++resetCount;
+	++generation;
+	++logEpoch;
+	updateActiveObject();
+
+	targetField.build(obstacles, gridW, gridH, {targetCell});
+	rebuildObjectField();
+}
+
+void Environment2D::rebuildObjectField() {
+	if (objectIndex.empty()) objectField.invalidate();
+	else objectField.build(obstacles, gridW, gridH, objectIndex.items());
+}
+
+void Environment2D::updateActiveObject() {
+	Vec2i nearest;
+	if (!carrying && objectIndex.nearest(robotCell, nearest)) objectCell = nearest;
+}
+
+void Environment2D::writeCell(int i, CellType t) {
+	const CellType before = grid[i];
+	if (before == CellType::Obstacle || before == CellType::Object || t == CellType::Obstacle || t == CellType::Object) ++generation;
+	grid[i] = t;
+	if (t == CellType::Obstacle) obstacles.set(i % gridW, i / gridW);
+	else obstacles.reset(i % gridW, i / gridW);
+}
+
+void Environment2D::setCell(const Vec2i& c, CellType t) {
+	int i = idx(c.x, c.y);
+	if (grid[i] == t) return;
+	undoLog.push_back({i, grid[i], t});
+	writeCell(i, t);
+}
+
+void Environment2D::syncRobotPosition() {
+	const float cs = config.cellSize;
+	robot.position = {robotCell.x * cs + cs * 0.5f, robotCell.y * cs + cs * 0.5f};
+	robotTarget = robot.position;
+}
+
+std::size_t Environment2D::memoryFootprint() const {
+	return grid.capacity() * sizeof(CellType) + obstacles.sizeBytes() +
+		targetField.sizeBytes() + objectField.sizeBytes() + objectIndex.sizeBytes() +
+		undoLog.capacity() * sizeof(CellChange) + objectLog.capacity() * sizeof(ObjectChange) +
+		planner.sizeBytes() + hierarchy.sizeBytes();
+}
+
+StateKey Environment2D::stateKey() const {
+	StateKey k;
+	k.robotCell = robotCell;
+	k.targetCell = targetCell;
+	k.objectCell = objectCell;
+	k.carrying = carrying;
+	k.obstacleNeighbor = hasObstacleNeighbor();
+	return k;
+}
+
+EnvMark Environment2D::mark() const {
+	EnvMark m;
+	m.logSize = undoLog.size();
+	m.objectLogSize = objectLog.size();
+	m.resetCount = resetCount;
+	m.robotCell = robotCell;
+	m.objectCell = objectCell;
+	m.carrying = carrying;
+	return m;
+}
+
+void Environment2D::rollback(const EnvMark& m) {
+	assert(m.resetCount == resetCount && m.logSize <= undoLog.size() && m.objectLogSize <= objectLog.size());
+	if (m.resetCount != resetCount) return;
+	bool obstaclesChanged = false;
+	for (std::size_t i = undoLog.size(); i > m.logSize; --i) {
+		const CellChange& c = undoLog[i - 1];
+		obstaclesChanged = obstaclesChanged || c.before == CellType::Obstacle || c.after == CellType::Obstacle;
+		writeCell(c.index, c.before);
+	}
+	undoLog.resize(m.logSize);
+	++logEpoch;
+	bool objectChanged = objectCell != m.objectCell || carrying != m.carrying || objectLog.size() != m.objectLogSize;
+	for (std::size_t i = objectLog.size(); i > m.objectLogSize; --i) {
+		const ObjectChange& c = objectLog[i - 1];
+		if (c.added) objectIndex.erase(c.cell);
+		else objectIndex.insert(c.cell);
+	}
+	objectLog.resize(m.objectLogSize);
+	robotCell = m.robotCell;
+	objectCell = m.objectCell;
+	carrying = m.carrying;
+	syncRobotPosition();
+	// restored obstacles can lengthen paths, which the incremental repair cannot express
+	if (obstaclesChanged) targetField.build(obstacles, gridW, gridH, {targetCell});
+	if (obstaclesChanged || objectChanged) rebuildObjectField();
 }
 
-bool Environment2D::isObstacle(const sf::Vector2i& cell) const {
+std::vector<CellChange> Environment2D::diff(const EnvMark& m) const {
+	std::vector<CellChange> out;
+	if (m.resetCount != resetCount) return out;
+	out.assign(undoLog.begin() + static_cast<std::ptrdiff_t>(m.logSize), undoLog.end());
+	// group writes by cell in O(k log k); stable, so the first write per cell,
+	// which carries the value at mark time, survives the unique
+	std::stable_sort(out.begin(), out.end(), [](const CellChange& a, const CellChange& b) { return a.index < b.index; });
+	out.erase(std::unique(out.begin(), out.end(), [](const CellChange& a, const CellChange& b) { return a.index == b.index; }), out.end());
+	for (CellChange& c : out) c.after = grid[c.index];
+	out.erase(std::remove_if(out.begin(), out.end(), [](const CellChange& c) { return c.before == c.after; }), out.end());
+	return out;
+}
+
+bool Environment2D::isObstacle(const Vec2i& cell) const {
 	if (cell.x < 0 || cell.x >= gridW || cell.y < 0 || cell.y >= gridH) return true;
-	CellType t = grid[idx(cell.x, cell.y)];
-	return t == CellType::Obstacle;
+	return obstacles.test(cell.x, cell.y);
 }
 
 bool Environment2D::hasObstacleNeighbor() const {
-	static const int dx[4] = {1, -1, 0, 0};
-	static const int dy[4] = {0, 0, 1, -1};
-	for (int k = 0; k < 4; ++k) {
-		int nx = robotCell.x + dx[k];
-		int ny = robotCell.y + dy[k];
-		if (nx >= 0 && nx < gridW && ny >= 0 && ny < gridH) {
-			if (grid[idx(nx, ny)] == CellType::Obstacle) return true;
-		}
-	}
-	return false;
+	return obstacles.neighborMask(robotCell.x, robotCell.y) != 0;
 }
 
 bool Environment2D::clearAnyAdjacentObstacle() {
 	static const int dx[4] = {1, -1, 0, 0};
 	static const int dy[4] = {0, 0, 1, -1};
+	// index of the lowest set bit of a 4-bit neighbor mask (same order as dx/dy)
+	static const int lowestBit[16] = {0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0};
 	// cannot clear obstacles while carrying an object
 	if (carrying) return false;
 
-	for (int k = 0; k < 4; ++k) {
-		int nx = robotCell.x + dx[k];
-		int ny = robotCell.y + dy[k];
-		if (nx >= 0 && nx < gridW && ny >= 0 && ny < gridH) {
-			if (grid[idx(nx, ny)] == CellType::Obstacle) {
-				grid[idx(nx, ny)] = CellType::Empty;
-				std::cout << "Env: cleared obstacle at (" << nx << "," << ny << ")" << std::endl;
-				return true;
-			}
-		}
-	}
-	return false;
+	unsigned mask = obstacles.neighborMask(robotCell.x, robotCell.y);
+	if (!mask) return false;
+	int k = lowestBit[mask];
+	return clearObstacleAt({robotCell.x + dx[k], robotCell.y + dy[k]});
+}
+
+bool Environment2D::clearObstacleAt(const Vec2i& c) {
+	if (carrying) return false;
+	if (std::abs(c.x - robotCell.x) + std::abs(c.y - robotCell.y) != 1) return false;
+	if (c.x < 0 || c.x >= gridW || c.y < 0 || c.y >= gridH || !obstacles.test(c.x, c.y)) return false;
+	setCell(c, CellType::Empty);
+	targetField.cellCleared(obstacles, c);
+	objectField.cellCleared(obstacles, c);
+	O3F_LOG_TRACE("Env: cleared obstacle at (" << c.x << "," << c.y << ")");
+	return true;
 }
 
 bool Environment2D::dropObjectLeft() {
 	if (!carrying) return false;
 	// preferred drop is one cell to the left
-	std::vector<sf::Vector2i> candidates;
+	std::vector<Vec2i> candidates;
 	candidates.push_back({robotCell.x - 1, robotCell.y}); // left
 	candidates.push_back({robotCell.x - 1, robotCell.y - 1}); // left-up
 	candidates.push_back({robotCell.x - 1, robotCell.y + 1}); // left-down
@@ -142,17 +321,21 @@ bool Environment2D::dropObjectLeft() {
 		if (c == targetCell) continue;
 		// cell must be empty (not obstacle, not robot)
 		if (grid[idx(c.x, c.y)] == CellType::Empty) {
-			objectCell = c;
-			grid[idx(objectCell.x, objectCell.y)] = CellType::Object;
+			setCell(c, CellType::Object);
+			objectIndex.insert(c);
+			objectLog.push_back({c, true});
 			carrying = false;
-			std::cout << "Env: robot dropped object at (" << objectCell.x << "," << objectCell.y << ")" << std::endl;
+			updateActiveObject();
+			// a source was added; drops are rare so a full rebuild is fine
+			rebuildObjectField();
+			O3F_LOG_TRACE("Env: robot dropped object at (" << c.x << "," << c.y << ")");
 			return true;
 		}
 	}
 	return false;
 }
 
-float Environment2D::computeReward(const sf::Vector2i& prevRobotCell) const {
+float Environment2D::computeReward(const Vec2i& prevRobotCell) const {
 	float r = 0.f;
 	
 	// 1. Success reward for delivering the carried object to target (large bonus)
@@ -170,10 +353,17 @@ float Environment2D::computeReward(const sf::Vector2i& prevRobotCell) const {
 	}
 	
 	// 4. Distance-based reward (the main signal)
+	// True path distance from the target field; Manhattan when either cell has no path
 	float prevDist = std::abs(prevRobotCell.x - targetCell.x) + 
 	                 std::abs(prevRobotCell.y - targetCell.y);
 	float currDist = std::abs(robotCell.x - targetCell.x) + 
 	                 std::abs(robotCell.y - targetCell.y);
+	std::int32_t prevPath = targetField.at(prevRobotCell);
+	std::int32_t currPath = targetField.at(robotCell);
+	if (prevPath != DistanceField::kUnreachable && currPath != DistanceField::kUnreachable) {
+		prevDist = static_cast<float>(prevPath);
+		currDist = static_cast<float>(currPath);
+	}
 	
 	float distChange = prevDist - currDist;
 	
@@ -196,63 +386,57 @@ float Environment2D::computeReward(const sf::Vector2i& prevRobotCell) const {
 }
 
 // New method: compute A* heuristic cost
-float Environment2D::computeHeuristicCost(const sf::Vector2i& from, const sf::Vector2i& to) const {
+float Environment2D::computeHeuristicCost(const Vec2i& from, const Vec2i& to) const {
 	// Manhattan distance as heuristic
 	return std::abs(from.x - to.x) + std::abs(from.y - to.y);
 }
 
-// New method: check if clearing obstacle is beneficial
-bool Environment2D::shouldClearObstacle(const sf::Vector2i& obstaclePos) const {
-	// Calculate cost of clearing vs going around
-	float clearCost = 2.0f; // Base cost for clearing
-	
-	// Check if obstacle blocks a direct path to target
-	sf::Vector2i toTarget = targetCell - robotCell;
-	sf::Vector2i toObstacle = obstaclePos - robotCell;
-	
-	// If obstacle is in the direct path to target, clearing might be worth it
-	if ((toTarget.x > 0 && toObstacle.x > 0) || (toTarget.x < 0 && toObstacle.x < 0)) {
-		if ((toTarget.y > 0 && toObstacle.y > 0) || (toTarget.y < 0 && toObstacle.y < 0)) {
-			// Obstacle is roughly in the direction of target
-			float directDistance = computeHeuristicCost(robotCell, targetCell);
-			float aroundDistance = computeHeuristicCost(robotCell, obstaclePos) + computeHeuristicCost(obstaclePos, targetCell);
-			
-			// If going around is much longer, clearing might be worth it
-			if (aroundDistance > directDistance + clearCost) {
-				return true;
-			}
-		}
+bool Environment2D::shouldClearObstacle(const Vec2i& obstaclePos) const {
+	return shouldClearObstacleToward(obstaclePos, targetCell);
+}
+
+bool Environment2D::shouldClearObstacleToward(const Vec2i& obstaclePos, const Vec2i& dest) const {
+	if (!isObstacle(obstaclePos) || !planClearingPath(dest, clearingPlan)) return false;
+	return std::find(clearingPlan.clears.begin(), clearingPlan.clears.end(), obstaclePos) != clearingPlan.clears.end();
+}
+
+bool Environment2D::planClearingPath(const Vec2i& dest, ClearingPlan& plan) const {
+	if (!planner.plan(*this, robotCell, dest)) {
+		plan.path.clear();
+		plan.clears.clear();
+		plan.cost = 0;
+		return false;
 	}
-	
-	return false;
+	planner.extractPath(plan);
+	return true;
 }
 
-bool Environment2D::shouldClearObstacleToward(const sf::Vector2i& obstaclePos, const sf::Vector2i& dest) const {
-	// Similar to shouldClearObstacle but compares direction to an explicit destination
-	float clearCost = 2.0f; // Base cost for clearing
+bool Environment2D::nextPlannedCell(const Vec2i& dest, Vec2i& next) const {
+	if (robotCell == dest) return false;
+	return planner.plan(*this, robotCell, dest) && planner.nextCell(next);
+}
 
-	sf::Vector2i toDest = dest - robotCell;
-	sf::Vector2i toObstacle = obstaclePos - robotCell;
+bool Environment2D::hasPlannedClear(const Vec2i& dest) const {
+	Vec2i next;
+	return !carrying && nextPlannedCell(dest, next) && obstacles.test(next.x, next.y);
+}
 
-	if ((toDest.x > 0 && toObstacle.x > 0) || (toDest.x < 0 && toObstacle.x < 0)) {
-		if ((toDest.y > 0 && toObstacle.y > 0) || (toDest.y < 0 && toObstacle.y < 0)) {
-			float directDistance = computeHeuristicCost(robotCell, dest);
-			float aroundDistance = computeHeuristicCost(robotCell, obstaclePos) + computeHeuristicCost(obstaclePos, dest);
-			if (aroundDistance > directDistance + clearCost) {
-				return true;
-			}
-		}
-	}
-	return false;
+bool Environment2D::clearPlannedObstacle(const Vec2i& dest) {
+	Vec2i next;
+	if (carrying || !nextPlannedCell(dest, next)) return false;
+	return clearObstacleAt(next);
 }
 
 float Environment2D::step(Action action) {
-	sf::Vector2i prev = robotCell;
+	Vec2i prev = robotCell;
 	// clear previous robot cell
 	if (robotCell.x >= 0 && robotCell.x < gridW && robotCell.y >= 0 && robotCell.y < gridH) {
-		if (grid[idx(robotCell.x, robotCell.y)] == CellType::Robot) grid[idx(robotCell.x, robotCell.y)] = CellType::Empty;
+		// a carrying robot may stand on another object, which reappears as it leaves
+		if (grid[idx(robotCell.x, robotCell.y)] == CellType::Robot) {
+			setCell(robotCell, objectIndex.contains(robotCell) ? CellType::Object : CellType::Empty);
+		}
 	}
-	sf::Vector2i next = robotCell;
+	Vec2i next = robotCell;
 	switch (action) {
 		case Action::Up: next.y -= 1; break;
 		case Action::Down: next.y += 1; break;
@@ -265,28 +449,48 @@ float Environment2D::step(Action action) {
 	if (!isObstacle(next)) {
 		robotCell = next;
 	}
-	// If robot moved onto the object cell and not already carrying, pick it up
-	if (!carrying && robotCell == objectCell) {
+	// If robot moved onto an object cell and not already carrying, pick it up
+	if (!carrying && objectIndex.erase(robotCell)) {
 		carrying = true;
+		objectCell = robotCell;
+		objectLog.push_back({robotCell, false});
 		// remove object from grid
-		grid[idx(objectCell.x, objectCell.y)] = CellType::Empty;
-		std::cout << "Env: robot picked up object at (" << objectCell.x << "," << objectCell.y << ")" << std::endl;
+		setCell(objectCell, CellType::Empty);
+		// a source disappeared, so distances can only grow: rebuild
+		rebuildObjectField();
+		O3F_LOG_TRACE("Env: robot picked up object at (" << objectCell.x << "," << objectCell.y << ")");
+	} else if (robotCell != prev) {
+		updateActiveObject();
 	}
 	if (grid[idx(targetCell.x, targetCell.y)] != CellType::Robot) {
-		grid[idx(targetCell.x, targetCell.y)] = CellType::Target;
+		setCell(targetCell, CellType::Target);
 	}
-	grid[idx(robotCell.x, robotCell.y)] = CellType::Robot;
+	setCell(robotCell, CellType::Robot);
 
-	robot.position = {robotCell.x * CELL_SIZE + CELL_SIZE * 0.5f, robotCell.y * CELL_SIZE + CELL_SIZE * 0.5f};
-	robotTarget = robot.position;
+	syncRobotPosition();
 	return computeReward(prev);
 }
 
-void Environment2D::setRobotTarget(const sf::Vector2f& target) {
+bool Environment2D::placeRobot(const Vec2i& cell) {
+	if (cell.x < 0 || cell.x >= gridW || cell.y < 0 || cell.y >= gridH || isObstacle(cell)) return false;
+	if (grid[idx(robotCell.x, robotCell.y)] == CellType::Robot) {
+		setCell(robotCell, objectIndex.contains(robotCell) ? CellType::Object : CellType::Empty);
+	}
+	robotCell = cell;
+	updateActiveObject();
+	if (grid[idx(targetCell.x, targetCell.y)] != CellType::Robot) {
+		setCell(targetCell, CellType::Target);
+	}
+	setCell(robotCell, CellType::Robot);
+	syncRobotPosition();
+	return true;
+}
+
+void Environment2D::setRobotTarget(const Vec2f& target) {
 	robotTarget = target;
 }
 
-void Environment2D::resolveBoundaries(sf::Vector2f& pos, float r) {
+void Environment2D::resolveBoundaries(Vec2f& pos, float r) {
 	if (pos.x < r) pos.x = r;
 	if (pos.x > width - r) pos.x = width - r;
 	if (pos.y < r) pos.y = r;
@@ -294,26 +498,9 @@ void Environment2D::resolveBoundaries(sf::Vector2f& pos, float r) {
 }
 
 void Environment2D::step(float dt) {
-	sf::Vector2f toTarget = robotTarget - robot.position;
-	sf::Vector2f dir = normalize(toTarget);
+	Vec2f toTarget = robotTarget - robot.position;
+	Vec2f dir = normalize(toTarget);
 	robot.velocity = dir * robot.maxSpeed;
 	robot.position += robot.velocity * dt;
 	resolveBoundaries(robot.position, robot.radius);
 }
-
-void Environment2D::render(sf::RenderWindow& window) {
-	sf::RectangleShape cellShape({CELL_SIZE - 1.f, CELL_SIZE - 1.f});
-	for (int y = 0; y < gridH; ++y) {
-		for (int x = 0; x < gridW; ++x) {
-			CellType t = grid[idx(x, y)];
-			sf::Color c(40, 40, 45);
-			if (t == CellType::Obstacle) c = sf::Color(120, 60, 60);
-			if (t == CellType::Target) c = sf::Color(60, 120, 60);
-			if (t == CellType::Object) c = sf::Color(200, 200, 80);
-			if (t == CellType::Robot) c = sf::Color(80, 160, 220);
-			cellShape.setFillColor(c);
-			cellShape.setPosition(x * CELL_SIZE, y * CELL_SIZE);
-			window.draw(cellShape);
-		}
-	}
-}
@@ -1,26 +1,43 @@
 #include "Executor.hpp"
 #include "Env.hpp"
 #include "Option.hpp"
-#include <iostream>
+#include "Log.hpp"
+
+#include <cassert>
+#include <cmath>
 
 void OptionExecutor::tick(Environment2D& env, float dt) {
 	(void)env;
 	(void)dt;
 }
 
-float OptionExecutor::runPrimitiveUntil(Environment2D& env, int maxSteps,
-	const std::function<bool(const Environment2D&)>& goal,
-	const std::function<Action(const Environment2D&)>& policy) {
-	float total = 0.f;
-	sf::Vector2i lastPos = env.getRobotCell();
+// Reward adjustment credited on the option's last step
+static void addFinal(OptionResult& r, float amount, float gamma) {
+	r.reward += amount;
+	r.discountedReward += amount * std::pow(gamma, static_cast<float>(r.steps > 0 ? r.steps - 1 : 0));
+}
+
+// Primitive-step loop shared by every execution path. Goal and Policy are
+// plain callables, so for the concrete option types both calls are direct.
+template <class Goal, class Policy>
+static OptionResult runSteps(Environment2D& env, int maxSteps, float gamma, const Goal& goal, const Policy& policy) {
+	OptionResult r;
+	float discount = 1.f;
+	Vec2i lastPos = env.getRobotCell();
 	int stepsInSamePlace = 0;
 	
 	for (int i = 0; i < maxSteps; ++i) {
-		if (goal && goal(env)) break;
+		if (goal(env)) {
+			r.reason = OptionTermination::Goal;
+			return r;
+		}
 		
-		Action a = policy ? policy(env) : Action::None;
+		Action a = policy(env);
 		float stepReward = env.step(a);
-		total += stepReward;
+		++r.steps;
+		r.reward += stepReward;
+		r.discountedReward += discount * stepReward;
+		discount *= gamma;
 		
 		// Check if robot is stuck in same position
 		if (env.getRobotCell() == lastPos) {
@@ -28,8 +45,9 @@ float OptionExecutor::runPrimitiveUntil(Environment2D& env, int maxSteps,
 			// If stuck for 3+ steps, give up on this option
 			// Reduced penalty from -5.0 to -2.0 to be more lenient with clearing costs
 			if (stepsInSamePlace >= 3) {
-				total -= 2.0f; // Reduced penalty for getting stuck
-				break;
+				addFinal(r, -2.0f, gamma); // Reduced penalty for getting stuck
+				r.reason = OptionTermination::Stuck;
+				return r;
 			}
 		} else {
 			stepsInSamePlace = 0;
@@ -37,78 +55,81 @@ float OptionExecutor::runPrimitiveUntil(Environment2D& env, int maxSteps,
 		}
 		
 		// Early termination if reward becomes very negative
-		if (total < -15.0f) {
-			break;
+		if (r.reward < -15.0f) {
+			r.reason = OptionTermination::RewardFloor;
+			return r;
 		}
 	}
-	return total;
+	r.reason = goal(env) ? OptionTermination::Goal : OptionTermination::MaxSteps;
+	return r;
 }
 
-float OptionExecutor::executeOption(Environment2D& env, const Option& option, int maxSteps) {
+OptionResult OptionExecutor::runPrimitiveUntil(Environment2D& env, int maxSteps,
+	const std::function<bool(const Environment2D&)>& goal,
+	const std::function<Action(const Environment2D&)>& policy) {
+	return runSteps(env, maxSteps, gamma,
+		[&goal](const Environment2D& e) { return goal && goal(e); },
+		[&policy](const Environment2D& e) { return policy ? policy(e) : Action::None; });
+}
+
+template <class Opt>
+static OptionResult runOption(Environment2D& env, const Option& option, OptionContext& ctx, int maxSteps, float gamma) {
+	assert(dynamic_cast<const Opt*>(&option) && "option reports a built-in OptionId it does not implement");
+	const Opt& opt = static_cast<const Opt&>(option);
+	return runSteps(env, maxSteps, gamma,
+		[&opt](const Environment2D& e) { return opt.reached(e); },
+		[&opt, &ctx](const Environment2D& e) { return opt.act(e, ctx); });
+}
+
+OptionResult OptionExecutor::executeOption(Environment2D& env, const Option& option, OptionContext& ctx, int maxSteps) {
 	// Default phase is -1 (no special handling)
-	return executeOption(env, option, maxSteps, -1);
+	return executeOption(env, option, ctx, maxSteps, -1);
 }
 
-float OptionExecutor::executeOption(Environment2D& env, const Option& option, int maxSteps, int currentPhase) {
-	sf::Vector2i startPos = env.getRobotCell();
-	float reward = runPrimitiveUntil(env, maxSteps, option.goal(), option.policy());
-	sf::Vector2i endPos = env.getRobotCell();
+OptionResult OptionExecutor::executeOption(Environment2D& env, const Option& option, OptionContext& ctx, int maxSteps, int currentPhase) {
+	Vec2i startPos = env.getRobotCell();
+	const bool clearing = option.id() == OptionId::ClearObstacle;
+	OptionResult result;
+	switch (option.id()) {
+	case OptionId::MoveToTarget: result = runOption<MoveToTargetOption>(env, option, ctx, maxSteps, gamma); break;
+	case OptionId::ClearObstacle: result = runOption<ClearObstacleOption>(env, option, ctx, maxSteps, gamma); break;
+	case OptionId::MoveToObject: result = runOption<MoveToObjectOption>(env, option, ctx, maxSteps, gamma); break;
+	case OptionId::MoveObjectToTarget: result = runOption<MoveObjectToTargetOption>(env, option, ctx, maxSteps, gamma); break;
+	case OptionId::ReturnToObject: result = runOption<ReturnToObjectOption>(env, option, ctx, maxSteps, gamma); break;
+	// no reached()/act() to call directly: run through goal() and policy()
+	case OptionId::GraspTarget:
+	case OptionId::Custom:
+		result = runPrimitiveUntil(env, maxSteps, option.goal(), option.policy(ctx));
+		break;
+	}
+	Vec2i endPos = env.getRobotCell();
 	
 	// Additional penalty if option didn't accomplish anything meaningful
 	// Skip this penalty for ClearObstacle in Phase 2 - not moving is expected when clearing
-	if (startPos == endPos && option.name() != "ClearObstacle") {
-		reward -= 3.0f; // Penalty for wasting time
+	if (startPos == endPos && !clearing) {
+		addFinal(result, -3.0f, gamma); // Penalty for wasting time
 	}
 	
 	// Handle ClearObstacle option specifically
-	if (option.name() == std::string("ClearObstacle")) {
+	if (clearing) {
 		if (env.hasObstacleNeighbor()) {
-			// Check if clearing is beneficial
-			static const int dx[4] = {1, -1, 0, 0};
-			static const int dy[4] = {0, 0, 1, -1};
-			bool clearedSomething = false;
-			
-			// In Phase 2 (MoveToObject), clear ANY adjacent obstacle freely
-			if (currentPhase == 2) {
-				if (env.clearAnyAdjacentObstacle()) {
-					clearedSomething = true;
-					// No reward in phase 2 - clearing is necessary cost
-				}
-			} else {
-				// In other phases, prefer to clear strategic obstacles first
-				for (int k = 0; k < 4; ++k) {
-					int nx = env.getRobotCell().x + dx[k];
-					int ny = env.getRobotCell().y + dy[k];
-					if (nx >= 0 && nx < env.getGridWidth() && ny >= 0 && ny < env.getGridHeight()) {
-						sf::Vector2i obstaclePos(nx, ny);
-						if (env.isObstacle(obstaclePos) && env.shouldClearObstacle(obstaclePos)) {
-							if (env.clearAnyAdjacentObstacle()) {
-								reward += 2.0f; // Reward for strategic clearing
-								clearedSomething = true;
-								break;
-							}
-						}
-					}
-				}
-				// If we didn't clear anything strategic, try to clear any adjacent obstacle
-				if (!clearedSomething) {
-					if (env.clearAnyAdjacentObstacle()) {
-						reward += 1.0f; // smaller reward for non-strategic clear
-						clearedSomething = true;
-						std::cout << "Cleared adjacent obstacle (non-strategic)\n";
-					}
-				}
-			}
+			// Only clear the obstacle the minimum clearing-cost path runs into next:
+			// toward the object in Phase 2 (ReturnToObject), the target otherwise
+			const Vec2i dest = currentPhase == 2 ? env.getObjectCell() : env.getTargetCell();
+			bool clearedSomething = env.clearPlannedObstacle(dest);
+			// No reward in phase 2 - clearing is necessary cost
+			if (clearedSomething && currentPhase != 2) addFinal(result, 2.0f, gamma);
 			
-			// If still nothing cleared, apply a small penalty instead of a large one
-			if (!clearedSomething && env.hasObstacleNeighbor()) {
-				reward -= 1.0f; // smaller penalty for failed clear
+			// If nothing was worth clearing, apply a small penalty
+			if (!clearedSomething) {
+				addFinal(result, -1.0f, gamma);
+				O3F_LOG_TRACE("No adjacent obstacle on the planned path");
 			}
 		} else {
 			// No obstacle nearby - this option shouldn't have been selected
-			reward -= 3.0f; // reduced penalty
+			addFinal(result, -3.0f, gamma); // reduced penalty
 		}
 	}
 	
-	return reward;
+	return result;
 }
\ No newline at end of file
@@ -0,0 +1,405 @@
+#include "HierarchicalPathfinder.hpp"
+#include "Env.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+static const int dx[4] = {1, -1, 0, 0};
+static const int dy[4] = {0, 0, 1, -1};
+
+// Transition runs this long or longer get one transition at each end
+static const int kLongRun = 6;
+
+std::size_t HierarchicalPathfinder::nodeCount() const {
+	std::size_t n = 0;
+	for (const Cluster& c : clusters) n += c.nodes.size();
+	return n;
+}
+
+std::size_t HierarchicalPathfinder::sizeBytes() const {
+	std::size_t bytes = open.capacity() + borderDirty.capacity() + clusterDirty.capacity() +
+		(localIndex.capacity() + dirtyBorders.capacity() + dirtyClusters.capacity() + localQueue.capacity()) * sizeof(int) +
+		(stamp.capacity() + closed.capacity()) * sizeof(std::uint32_t) +
+		(g.capacity() + parent.capacity() + localDist.capacity() + goalDist.capacity()) * sizeof(std::int32_t) +
+		startEdges.capacity() * sizeof(Edge) +
+		heap.capacity() * sizeof(HeapEntry) + abstractPath.capacity() * sizeof(int);
+	for (const std::vector<Transition>& b : borders) bytes += b.capacity() * sizeof(Transition);
+	for (const Cluster& c : clusters) {
+		bytes += c.nodes.capacity() * sizeof(int) + c.links.capacity() * sizeof(Link) + c.dist.capacity() * sizeof(std::int32_t);
+	}
+	return bytes;
+}
+
+void HierarchicalPathfinder::sync(const Environment2D& env) {
+	rebuilt = 0;
+	const std::vector<CellChange>& log = env.cellChanges();
+	if (!built || env.getGridWidth() != w || env.getGridHeight() != h || env.changeEpoch() != epoch || logPos > log.size()) {
+		buildAll(env);
+		return;
+	}
+	const ObstacleBitboard& obstacles = env.getObstacles();
+	for (; logPos < log.size(); ++logPos) {
+		const int v = log[logPos].index;
+		const int x = v % w;
+		const int y = v / w;
+		const std::uint8_t now = (x > 0 && x < w - 1 && y > 0 && y < h - 1 && !obstacles.test(x, y)) ? 1 : 0;
+		if (now == open[v]) continue;
+		open[v] = now;
+		markCell(v);
+	}
+	// borders first: their transitions define the node sets of both clusters
+	for (int b : dirtyBorders) {
+		rebuildBorder(b);
+		borderDirty[b] = 0;
+	}
+	dirtyBorders.clear();
+	for (int c : dirtyClusters) {
+		rebuildCluster(c);
+		clusterDirty[c] = 0;
+	}
+	rebuilt = dirtyClusters.size();
+	dirtyClusters.clear();
+}
+
+void HierarchicalPathfinder::buildAll(const Environment2D& env) {
+	w = env.getGridWidth();
+	h = env.getGridHeight();
+	cw = (w + size - 1) / size;
+	ch = (h + size - 1) / size;
+	const std::size_t cells = static_cast<std::size_t>(w) * h;
+	const ObstacleBitboard& obstacles = env.getObstacles();
+	open.assign(cells, 0);
+	for (int y = 1; y < h - 1; ++y) {
+		for (int x = 1; x < w - 1; ++x) open[y * w + x] = obstacles.test(x, y) ? 0 : 1;
+	}
+	borders.assign(static_cast<std::size_t>(ch) * (cw - 1) + static_cast<std::size_t>(ch - 1) * cw, {});
+	clusters.assign(static_cast<std::size_t>(cw) * ch, {});
+	borderDirty.assign(borders.size(), 0);
+	clusterDirty.assign(clusters.size(), 0);
+	dirtyBorders.clear();
+	dirtyClusters.clear();
+	localIndex.assign(cells, -1);
+	stamp.assign(cells, 0);
+	closed.assign(cells, 0);
+	g.resize(cells);
+	parent.resize(cells);
+	stampEpoch = 0;
+	localDist.resize(static_cast<std::size_t>(size) * size);
+	for (std::size_t b = 0; b < borders.size(); ++b) rebuildBorder(static_cast<int>(b));
+	for (std::size_t c = 0; c < clusters.size(); ++c) rebuildCluster(static_cast<int>(c));
+	rebuilt = clusters.size();
+	epoch = env.changeEpoch();
+	logPos = env.cellChanges().size();
+	built = true;
+}
+
+void HierarchicalPathfinder::markBorder(int border) {
+	if (borderDirty[border]) return;
+	borderDirty[border] = 1;
+	dirtyBorders.push_back(border);
+	// both sides take their nodes from this border
+	const int vertical = ch * (cw - 1);
+	if (border < vertical) {
+		const int cy = border / (cw - 1);
+		const int cx = border % (cw - 1);
+		markCluster(cy * cw + cx);
+		markCluster(cy * cw + cx + 1);
+	} else {
+		const int i = border - vertical;
+		markCluster(i);
+		markCluster(i + cw);
+	}
+}
+
+void HierarchicalPathfinder::markCluster(int c) {
+	if (clusterDirty[c]) return;
+	clusterDirty[c] = 1;
+	dirtyClusters.push_back(c);
+}
+
+void HierarchicalPathfinder::markCell(int cell) {
+	const int x = cell % w;
+	const int y = cell / w;
+	const int cx = x / size;
+	const int cy = y / size;
+	markCluster(cy * cw + cx);
+	const int vertical = ch * (cw - 1);
+	if (x % size == 0 && cx > 0) markBorder(cy * (cw - 1) + cx - 1);
+	if (x % size == size - 1 && cx + 1 < cw) markBorder(cy * (cw - 1) + cx);
+	if (y % size == 0 && cy > 0) markBorder(vertical + (cy - 1) * cw + cx);
+	if (y % size == size - 1 && cy + 1 < ch) markBorder(vertical + cy * cw + cx);
+}
+
+void HierarchicalPathfinder::rebuildBorder(int border) {
+	std::vector<Transition>& out = borders[border];
+	out.clear();
+	const int vertical = ch * (cw - 1);
+	// the border is a line of cell pairs (a, b) with a in the lower cluster
+	int a0, step, along, count;
+	if (border < vertical) {
+		const int cy = border / (cw - 1);
+		const int cx = border % (cw - 1);
+		const int y0 = cy * size;
+		a0 = y0 * w + (cx + 1) * size - 1;
+		step = w;
+		along = 1;
+		count = std::min(h, y0 + size) - y0;
+	} else {
+		const int i = border - vertical;
+		const int cy = i / cw;
+		const int cx = i % cw;
+		const int x0 = cx * size;
+		a0 = ((cy + 1) * size - 1) * w + x0;
+		step = 1;
+		along = w;
+		count = std::min(w, x0 + size) - x0;
+	}
+	int runStart = -1;
+	for (int t = 0; t <= count; ++t) {
+		const int a = a0 + t * step;
+		const bool both = t < count && open[a] && open[a + along];
+		if (both && runStart < 0) runStart = t;
+		if (both || runStart < 0) continue;
+		const int len = t - runStart;
+		if (len < kLongRun) {
+			const int mid = a0 + (runStart + len / 2) * step;
+			out.push_back({mid, mid + along});
+		} else {
+			const int first = a0 + runStart * step;
+			const int last = a0 + (t - 1) * step;
+			out.push_back({first, first + along});
+			out.push_back({last, last + along});
+		}
+		runStart = -1;
+	}
+}
+
+void HierarchicalPathfinder::rebuildCluster(int c) {
+	Cluster& cl = clusters[c];
+	for (int cell : cl.nodes) localIndex[cell] = -1;
+	cl.nodes.clear();
+	cl.links.clear();
+	const int cx = c % cw;
+	const int cy = c / cw;
+	const int vertical = ch * (cw - 1);
+	auto addSide = [&](int border, bool lowerSide) {
+		for (const Transition& t : borders[border]) {
+			const int mine = lowerSide ? t.a : t.b;
+			const int other = lowerSide ? t.b : t.a;
+			if (localIndex[mine] < 0) {
+				localIndex[mine] = static_cast<int>(cl.nodes.size());
+				cl.nodes.push_back(mine);
+			}
+			cl.links.push_back({localIndex[mine], other});
+		}
+	};
+	if (cx > 0) addSide(cy * (cw - 1) + cx - 1, false);
+	if (cx + 1 < cw) addSide(cy * (cw - 1) + cx, true);
+	if (cy > 0) addSide(vertical + (cy - 1) * cw + cx, false);
+	if (cy + 1 < ch) addSide(vertical + cy * cw + cx, true);
+
+	const std::size_t n = cl.nodes.size();
+	cl.dist.assign(n * n, kInf);
+	for (std::size_t i = 0; i < n; ++i) {
+		clusterBfs(c, cl.nodes[i]);
+		for (std::size_t j = 0; j < n; ++j) cl.dist[i * n + j] = localDistTo(c, cl.nodes[j]);
+	}
+}
+
+void HierarchicalPathfinder::clusterBfs(int c, int from) {
+	const int x0 = (c % cw) * size;
+	const int y0 = (c / cw) * size;
+	const int x1 = std::min(w, x0 + size);
+	const int y1 = std::min(h, y0 + size);
+	std::fill(localDist.begin(), localDist.end(), kInf);
+	localQueue.clear();
+	localDist[(from / w - y0) * size + (from % w - x0)] = 0;
+	localQueue.push_back(from);
+	for (std::size_t head = 0; head < localQueue.size(); ++head) {
+		const int cur = localQueue[head];
+		const int x = cur % w;
+		const int y = cur / w;
+		const std::int32_t nd = localDist[(y - y0) * size + (x - x0)] + 1;
+		for (int k = 0; k < 4; ++k) {
+			const int nx = x + dx[k];
+			const int ny = y + dy[k];
+			if (nx < x0 || nx >= x1 || ny < y0 || ny >= y1 || !passable(nx, ny)) continue;
+			std::int32_t& d = localDist[(ny - y0) * size + (nx - x0)];
+			if (d <= nd) continue;
+			d = nd;
+			localQueue.push_back(ny * w + nx);
+		}
+	}
+}
+
+std::int32_t HierarchicalPathfinder::localDistTo(int c, int cell) const {
+	const int x0 = (c % cw) * size;
+	const int y0 = (c / cw) * size;
+	return localDist[(cell / w - y0) * size + (cell % w - x0)];
+}
+
+bool HierarchicalPathfinder::refine(int c, int from, int to, std::vector<Vec2i>& out) {
+	// distances toward `to`, then walk downhill from `from`
+	clusterBfs(c, to);
+	const int x0 = (c % cw) * size;
+	const int y0 = (c / cw) * size;
+	const int x1 = std::min(w, x0 + size);
+	const int y1 = std::min(h, y0 + size);
+	const int fx = from % w;
+	const int fy = from / w;
+	std::int32_t d = kInf;
+	if (fx >= x0 && fx < x1 && fy >= y0 && fy < y1 && open[from]) {
+		d = localDistTo(c, from);
+	} else {
+		// a closed start is left but never entered: step onto its best neighbor in c
+		for (int k = 0; k < 4; ++k) {
+			const int nx = fx + dx[k];
+			const int ny = fy + dy[k];
+			if (nx < x0 || nx >= x1 || ny < y0 || ny >= y1) continue;
+			d = std::min(d, localDist[(ny - y0) * size + (nx - x0)] + 1);
+		}
+	}
+	if (d >= kInf) return false;
+	int cur = from;
+	while (d > 0) {
+		const int x = cur % w;
+		const int y = cur / w;
+		int next = -1;
+		for (int k = 0; k < 4 && next < 0; ++k) {
+			const int nx = x + dx[k];
+			const int ny = y + dy[k];
+			if (nx < x0 || nx >= x1 || ny < y0 || ny >= y1) continue;
+			if (localDist[(ny - y0) * size + (nx - x0)] == d - 1) next = ny * w + nx;
+		}
+		if (next < 0) return false;
+		cur = next;
+		--d;
+		out.push_back({cur % w, cur / w});
+	}
+	return true;
+}
+
+void HierarchicalPathfinder::nextStamp() {
+	if (++stampEpoch == 0) {
+		std::fill(stamp.begin(), stamp.end(), 0);
+		std::fill(closed.begin(), closed.end(), 0);
+		stampEpoch = 1;
+	}
+}
+
+bool HierarchicalPathfinder::heapAfter(const HeapEntry& a, const HeapEntry& b) {
+	return a.f > b.f;
+}
+
+void HierarchicalPathfinder::push(int cell, std::int32_t f) {
+	heap.push_back({f, cell});
+	std::push_heap(heap.begin(), heap.end(), heapAfter);
+}
+
+bool HierarchicalPathfinder::findPath(const Environment2D& env, const Vec2i& startCell, const Vec2i& goalCell, std::vector<Vec2i>& out) {
+	out.clear();
+	expanded = 0;
+	const int gw = env.getGridWidth();
+	const int gh = env.getGridHeight();
+	if (startCell.x < 0 || startCell.x >= gw || startCell.y < 0 || startCell.y >= gh) return false;
+	if (goalCell.x < 0 || goalCell.x >= gw || goalCell.y < 0 || goalCell.y >= gh) return false;
+	if (startCell == goalCell) return true;
+	sync(env);
+	const int start = startCell.y * w + startCell.x;
+	const int goal = goalCell.y * w + goalCell.x;
+	if (!open[goal]) return false;
+
+	// link start and goal into the abstract graph. A closed start (the robot
+	// may stand anywhere; only entered cells must be open) enters through its
+	// open neighbors, which can lie in other clusters.
+	const int gc = clusterOf(goal);
+	const Cluster& goalCluster = clusters[gc];
+	startEdges.clear();
+	for (int k = -1; k < 4; ++k) {
+		int entry = start;
+		if (k >= 0) {
+			if (open[start]) break;
+			const int nx = startCell.x + dx[k];
+			const int ny = startCell.y + dy[k];
+			if (nx < 0 || nx >= w || ny < 0 || ny >= h || !passable(nx, ny)) continue;
+			entry = ny * w + nx;
+		}
+		const std::int32_t offset = entry == start ? 0 : 1;
+		const int c = clusterOf(entry);
+		clusterBfs(c, entry);
+		for (int node : clusters[c].nodes) {
+			const std::int32_t d = localDistTo(c, node);
+			if (d < kInf) startEdges.push_back({node, offset + d});
+		}
+		if (c == gc && localDistTo(c, goal) < kInf) startEdges.push_back({goal, offset + localDistTo(c, goal)});
+	}
+	clusterBfs(gc, goal);
+	goalDist.resize(goalCluster.nodes.size());
+	for (std::size_t i = 0; i < goalCluster.nodes.size(); ++i) goalDist[i] = localDistTo(gc, goalCluster.nodes[i]);
+
+	// A* over transition cells; g/parent are indexed by cell and stamped per query
+	nextStamp();
+	heap.clear();
+	auto heuristic = [&](int cell) { return std::abs(cell % w - goalCell.x) + std::abs(cell / w - goalCell.y); };
+	auto relax = [&](int from, int to, std::int32_t cost) {
+		const std::int32_t ng = g[from] + cost;
+		if (stamp[to] == stampEpoch && ng >= g[to]) return;
+		stamp[to] = stampEpoch;
+		g[to] = ng;
+		parent[to] = from;
+		push(to, ng + heuristic(to));
+	};
+	stamp[start] = stampEpoch;
+	g[start] = 0;
+	parent[start] = -1;
+	push(start, heuristic(start));
+	bool found = false;
+	while (!heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end(), heapAfter);
+		const int u = heap.back().cell;
+		heap.pop_back();
+		if (closed[u] == stampEpoch) continue;
+		closed[u] = stampEpoch;
+		++expanded;
+		if (u == goal) {
+			found = true;
+			break;
+		}
+		if (u == start) {
+			for (const Edge& e : startEdges) relax(u, e.cell, e.cost);
+		}
+		const int li = localIndex[u];
+		if (li < 0) continue;
+		const int c = clusterOf(u);
+		const Cluster& cl = clusters[c];
+		const std::size_t n = cl.nodes.size();
+		if (u != start) {
+			for (std::size_t j = 0; j < n; ++j) {
+				const std::int32_t d = cl.dist[li * n + j];
+				if (d < kInf && static_cast<int>(j) != li) relax(u, cl.nodes[j], d);
+			}
+		}
+		for (const Link& l : cl.links) {
+			if (l.local == li) relax(u, l.other, 1);
+		}
+		if (c == gc && u != start && goalDist[li] < kInf) relax(u, goal, goalDist[li]);
+	}
+	if (!found) return false;
+
+	abstractPath.clear();
+	for (int c = goal; c != -1; c = parent[c]) abstractPath.push_back(c);
+	std::reverse(abstractPath.begin(), abstractPath.end());
+	for (std::size_t i = 1; i < abstractPath.size(); ++i) {
+		const int a = abstractPath[i - 1];
+		const int b = abstractPath[i];
+		const int cb = clusterOf(b);
+		if (a != start && clusterOf(a) != cb) {
+			// inter-cluster transition: a single step
+			out.push_back({b % w, b / w});
+		} else if (!refine(cb, a, b, out)) {
+			out.clear();
+			return false;
+		}
+	}
+	return true;
+}
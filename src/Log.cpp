@@ -0,0 +1,161 @@
+#include "Log.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <streambuf>
+
+namespace {
+
+// streambuf writing into a fixed array; output past the end is discarded
+class FixedBuffer : public std::streambuf {
+public:
+	void reset() { setp(data, data + Logger::kMessageSize); }
+	const char* text() const { return data; }
+	std::size_t length() const { return static_cast<std::size_t>(pptr() - pbase()); }
+protected:
+	int_type overflow(int_type ch) override { (void)ch; return traits_type::eof(); }
+private:
+	char data[Logger::kMessageSize];
+};
+
+struct ThreadStream {
+	FixedBuffer buffer;
+	std::ostream stream{&buffer};
+};
+
+ThreadStream& threadStream() {
+	thread_local ThreadStream ts;
+	return ts;
+}
+
+const char* levelTag(LogLevel level) {
+	switch (level) {
+		case LogLevel::Trace: return "[trace] ";
+		case LogLevel::Debug: return "[debug] ";
+		case LogLevel::Info: return "[info] ";
+		case LogLevel::Warn: return "[warn] ";
+		case LogLevel::Error: return "[error] ";
+		default: return "";
+	}
+}
+
+} // namespace
+
+Logger& Logger::instance() {
+	static Logger logger;
+	return logger;
+}
+
+Logger::Logger() : slots(new Slot[kCapacity]) {
+	for (std::size_t i = 0; i < kCapacity; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+	drainThread = std::thread(&Logger::drainLoop, this);
+}
+
+Logger::~Logger() {
+	stopping.store(true, std::memory_order_release);
+	if (drainThread.joinable()) drainThread.join();
+	if (dropped.load() > 0) {
+		std::fprintf(stderr, "[warn] logger dropped %llu messages (ring full)\n",
+			static_cast<unsigned long long>(dropped.load()));
+	}
+}
+
+void Logger::write(LogLevel level, const char* text, std::size_t len) {
+	// Bounded MPMC queue (Vyukov): producers claim a slot with one CAS and
+	// publish it by bumping the slot's sequence number
+	std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+	Slot* slot = nullptr;
+	for (;;) {
+		slot = &slots[pos & (kCapacity - 1)];
+		std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+		if (diff == 0) {
+			if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+		} else if (diff < 0) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		} else {
+			pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+	if (len > kMessageSize) len = kMessageSize;
+	std::memcpy(slot->text, text, len);
+	slot->length = static_cast<std::uint32_t>(len);
+	slot->level = level;
+	slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+std::ostream& Logger::beginMessage() {
+	ThreadStream& ts = threadStream();
+	ts.buffer.reset();
+	ts.stream.clear();
+	ts.stream.flags(std::ios_base::dec | std::ios_base::skipws);
+	ts.stream.precision(6);
+	ts.stream.width(0);
+	return ts.stream;
+}
+
+void Logger::endMessage(LogLevel level) {
+	ThreadStream& ts = threadStream();
+	write(level, ts.buffer.text(), ts.buffer.length());
+}
+
+bool Logger::drainOnce() {
+	std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+	bool wroteErr = false;
+	std::size_t count = 0;
+	for (;;) {
+		Slot& slot = slots[pos & (kCapacity - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != pos + 1) break;
+		std::FILE* out = slot.level >= LogLevel::Warn ? stderr : stdout;
+		wroteErr = wroteErr || out == stderr;
+		std::fputs(levelTag(slot.level), out);
+		std::fwrite(slot.text, 1, slot.length, out);
+		std::fputc('\n', out);
+		slot.sequence.store(pos + kCapacity, std::memory_order_release);
+		++pos;
+		++count;
+	}
+	if (count == 0) return false;
+	dequeuePos.store(pos, std::memory_order_relaxed);
+	// one flush per drained batch instead of one per line
+	std::fflush(stdout);
+	if (wroteErr) std::fflush(stderr);
+	writtenPos.store(pos, std::memory_order_release);
+	return true;
+}
+
+void Logger::drainLoop() {
+	for (;;) {
+		if (drainOnce()) continue;
+		if (stopping.load(std::memory_order_acquire)) {
+			// producers may have published between the empty check and the stop flag
+			if (!drainOnce()) break;
+			continue;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+void Logger::flush() {
+	const std::size_t target = enqueuePos.load(std::memory_order_acquire);
+	while (writtenPos.load(std::memory_order_acquire) < target) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+}
+
+bool parseLogLevel(const char* name, LogLevel& out) {
+	static const struct { const char* name; LogLevel level; } table[] = {
+		{"trace", LogLevel::Trace}, {"debug", LogLevel::Debug}, {"info", LogLevel::Info},
+		{"warn", LogLevel::Warn}, {"error", LogLevel::Error}, {"off", LogLevel::Off},
+	};
+	for (const auto& entry : table) {
+		if (std::strcmp(name, entry.name) == 0) {
+			out = entry.level;
+			return true;
+		}
+	}
+	return false;
+}
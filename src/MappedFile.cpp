@@ -0,0 +1,96 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this == &other) return *this;
+	close();
+	bytes = other.bytes;
+	length = other.length;
+	other.bytes = nullptr;
+	other.length = 0;
+#ifdef _WIN32
+	fileHandle = other.fileHandle;
+	mappingHandle = other.mappingHandle;
+	other.fileHandle = nullptr;
+	other.mappingHandle = nullptr;
+#endif
+	return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+	close();
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	fileHandle = file;
+	mappingHandle = mapping;
+	bytes = static_cast<const std::uint8_t*>(view);
+	length = static_cast<std::size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes) UnmapViewOfFile(bytes);
+	if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+	if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+	bytes = nullptr;
+	length = 0;
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+	close();
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		::close(fd);
+		return false;
+	}
+	void* view = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping keeps its own reference to the file
+	::close(fd);
+	if (view == MAP_FAILED) return false;
+	bytes = static_cast<const std::uint8_t*>(view);
+	length = static_cast<std::size_t>(st.st_size);
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes) munmap(const_cast<std::uint8_t*>(bytes), length);
+	bytes = nullptr;
+	length = 0;
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include "ObjectIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+void ObjectIndex::reset(int gridWidth, int gridHeight, std::size_t expectedCount) {
+	w = gridWidth;
+	h = gridHeight;
+	double cellsPerObject = static_cast<double>(w) * h / static_cast<double>(std::max<std::size_t>(expectedCount, 1));
+	bucketSide = std::max(4, static_cast<int>(std::ceil(std::sqrt(cellsPerObject))));
+	bucketsX = (w + bucketSide - 1) / bucketSide;
+	bucketsY = (h + bucketSide - 1) / bucketSide;
+	// keep bucket storage across resets of the same layout
+	if (buckets.size() != static_cast<std::size_t>(bucketsX) * bucketsY) {
+		buckets.assign(static_cast<std::size_t>(bucketsX) * bucketsY, {});
+	} else {
+		for (auto& b : buckets) b.clear();
+	}
+	cells.clear();
+}
+
+void ObjectIndex::insert(const Vec2i& cell) {
+	buckets[bucketOf(cell)].push_back(cell);
+	cells.push_back(cell);
+}
+
+static bool eraseOne(std::vector<Vec2i>& v, const Vec2i& cell) {
+	auto it = std::find(v.begin(), v.end(), cell);
+	if (it == v.end()) return false;
+	*it = v.back();
+	v.pop_back();
+	return true;
+}
+
+bool ObjectIndex::erase(const Vec2i& cell) {
+	if (cell.x < 0 || cell.x >= w || cell.y < 0 || cell.y >= h) return false;
+	if (!eraseOne(buckets[bucketOf(cell)], cell)) return false;
+	eraseOne(cells, cell);
+	return true;
+}
+
+bool ObjectIndex::contains(const Vec2i& cell) const {
+	if (cell.x < 0 || cell.x >= w || cell.y < 0 || cell.y >= h) return false;
+	const auto& b = buckets[bucketOf(cell)];
+	return std::find(b.begin(), b.end(), cell) != b.end();
+}
+
+bool ObjectIndex::nearest(const Vec2i& from, Vec2i& out) const {
+	if (cells.empty()) return false;
+	const int bx = std::min(std::max(from.x / bucketSide, 0), bucketsX - 1);
+	const int by = std::min(std::max(from.y / bucketSide, 0), bucketsY - 1);
+	int best = -1;
+	auto consider = [&](int x, int y) {
+		for (const Vec2i& c : buckets[y * bucketsX + x]) {
+			int d = std::abs(c.x - from.x) + std::abs(c.y - from.y);
+			if (best < 0 || d < best || (d == best && (c.y < out.y || (c.y == out.y && c.x < out.x)))) {
+				best = d;
+				out = c;
+			}
+		}
+	};
+	const int maxRing = std::max(std::max(bx, bucketsX - 1 - bx), std::max(by, bucketsY - 1 - by));
+	for (int r = 0; r <= maxRing; ++r) {
+		// every cell in ring r is at least (r - 1) * bucketSide + 1 away
+		if (best >= 0 && r > 0 && best < (r - 1) * bucketSide + 1) break;
+		const int x0 = bx - r, x1 = bx + r, y0 = by - r, y1 = by + r;
+		for (int x = std::max(x0, 0); x <= std::min(x1, bucketsX - 1); ++x) {
+			if (y0 >= 0) consider(x, y0);
+			if (r > 0 && y1 < bucketsY) consider(x, y1);
+		}
+		for (int y = std::max(y0 + 1, 0); y <= std::min(y1 - 1, bucketsY - 1); ++y) {
+			if (x0 >= 0) consider(x0, y);
+			if (r > 0 && x1 < bucketsX) consider(x1, y);
+		}
+	}
+	return true;
+}
+
+std::size_t ObjectIndex::sizeBytes() const {
+	std::size_t bytes = buckets.capacity() * sizeof(std::vector<Vec2i>) + cells.capacity() * sizeof(Vec2i);
+	for (const auto& b : buckets) bytes += b.capacity() * sizeof(Vec2i);
+	return bytes;
+}
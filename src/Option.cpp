@@ -1,127 +1,25 @@
 #include "Option.hpp"
 #include "Env.hpp"
+#include "Navigation.hpp"
+#include "Pathfinder.hpp"
 
 #include <limits>
 #include <cmath>
 #include <algorithm>
 #include <vector>
-#include <queue>
-#include <unordered_map>
 
 // Helper function to check if a cell is on the boundary (edge of environment)
-static bool isBoundaryCell(const sf::Vector2i& cell, int gridW, int gridH) {
+static bool isBoundaryCell(const Vec2i& cell, int gridW, int gridH) {
 	return (cell.x <= 0 || cell.x >= gridW - 1 || cell.y <= 0 || cell.y >= gridH - 1);
 }
 
-// Helper function to track move history and detect stuck loops
-static void updateMoveHistory(std::vector<Action>& history, int& consecutiveCount, Action newAction) {
-	// Keep only last 5 moves for memory efficiency
-	if (history.size() > 5) {
-		history.erase(history.begin());
-	}
-	
-	// Check if this action is the same as the last action
-	if (!history.empty() && history.back() == newAction) {
-		consecutiveCount++;
-	} else {
-		consecutiveCount = 1;
-	}
-	
-	history.push_back(newAction);
-}
-
 // Helper function to check if agent is stuck in a loop (same move 3+ times)
 static bool isStuckInLoop(int consecutiveCount) {
 	return consecutiveCount >= 3;
 }
 
-// Helper function to find if path is blocked and return direction to nearest blocking obstacle
-// Returns the next action toward the nearest blocking obstacle if path is blocked
-// Returns Action::None if path is clear
-static Action findNextActionTowardBlockingObstacle(const Environment2D& env, const sf::Vector2i& target) {
-	int w = env.getGridWidth();
-	int h = env.getGridHeight();
-	auto start = env.getRobotCell();
-	
-	if (start == target) return Action::None;
-	
-	auto idx = [&](int x, int y){ return y * w + x; };
-	
-	// First, check if we can reach target via BFS (ignoring obstacles)
-	std::vector<int> parent(w * h, -1);
-	std::queue<int> q;
-	int s = idx(start.x, start.y);
-	int g = idx(target.x, target.y);
-	q.push(s);
-	parent[s] = s;
-	
-	static const int dx[4] = {1, -1, 0, 0};
-	static const int dy[4] = {0, 0, 1, -1};
-	
-	bool foundTarget = false;
-	std::vector<int> distToTarget(w * h, -1);
-	distToTarget[s] = std::abs(start.x - target.x) + std::abs(start.y - target.y);
-	
-	// BFS ignoring obstacles to find theoretical shortest path
-	while (!q.empty()) {
-		int cur = q.front(); q.pop();
-		int cx = cur % w;
-		int cy = cur / w;
-		
-		if (cur == g) {
-			foundTarget = true;
-			break;
-		}
-		
-		for (int k = 0; k < 4; ++k) {
-			int nx = cx + dx[k];
-			int ny = cy + dy[k];
-			if (nx < 0 || nx >= w || ny < 0 || ny >= h) continue;
-			if (isBoundaryCell({nx, ny}, w, h)) continue;
-			
-			int ni = idx(nx, ny);
-			if (parent[ni] != -1) continue;  // Already visited
-			
-			parent[ni] = cur;
-			distToTarget[ni] = std::abs(nx - target.x) + std::abs(ny - target.y);
-			q.push(ni);
-		}
-	}
-	
-	if (!foundTarget) return Action::None;  // No theoretical path even ignoring obstacles
-	
-	// Now find obstacles on the theoretical shortest path
-	// Walk from start toward target, find first obstacle blocking direct progress
-	std::vector<sf::Vector2i> theoreticalPath;
-	int cur = g;
-	while (cur != s) {
-		int x = cur % w;
-		int y = cur / w;
-		theoreticalPath.push_back({x, y});
-		cur = parent[cur];
-	}
-	std::reverse(theoreticalPath.begin(), theoreticalPath.end());
-	
-	// Find the first obstacle on this path or adjacent to it
-	for (const auto& pathCell : theoreticalPath) {
-		if (env.isObstacle(pathCell)) {
-			// Found blocking obstacle on the path
-			// Move toward it
-			int dx_to_obs = pathCell.x - start.x;
-			int dy_to_obs = pathCell.y - start.y;
-			
-			if (dx_to_obs > 0) return Action::Right;
-			if (dx_to_obs < 0) return Action::Left;
-			if (dy_to_obs > 0) return Action::Down;
-			if (dy_to_obs < 0) return Action::Up;
-		}
-	}
-	
-	return Action::None;  // No blocking obstacles found
-}
-
-static Action smartPathfinding(const Environment2D& env, const sf::Vector2i& target) {
-	sf::Vector2i r = env.getRobotCell();
+static Action smartPathfinding(const Environment2D& env, const Vec2i& target) {
+	Vec2i r = env.getRobotCell();
 	
 	// Calculate direction to target
 	int dx = target.x - r.x;
@@ -132,7 +30,7 @@ static Action smartPathfinding(const Environment2D& env, const sf::Vector2i& tar
 	
 	struct MoveOption {
 		Action action;
-		sf::Vector2i pos;
+		Vec2i pos;
 		float priority;
 		bool blocked;
 	};
@@ -195,192 +93,95 @@ static Action smartPathfinding(const Environment2D& env, const sf::Vector2i& tar
 	return Action::None;
 }
 
-// BFS to find the full path from start to target, avoiding obstacles and boundary cells
-static std::vector<sf::Vector2i> bfsFullPath(const Environment2D& env, const sf::Vector2i& target) {
-	std::vector<sf::Vector2i> emptyPath;
-	int w = env.getGridWidth();
-	int h = env.getGridHeight();
-	auto start = env.getRobotCell();
-	if (start == target) return emptyPath;
-
-	auto idx = [&](int x, int y){ return y * w + x; };
-
-	std::vector<int> parent(w * h, -1);
-	std::queue<int> q;
-	int s = idx(start.x, start.y);
-	int g = idx(target.x, target.y);
-	q.push(s);
-	parent[s] = s;
-
-	static const int dx[4] = {1, -1, 0, 0};
-	static const int dy[4] = {0, 0, 1, -1};
-
-	bool found = false;
-	while (!q.empty()) {
-		int cur = q.front(); q.pop();
-		int cx = cur % w;
-		int cy = cur / w;
-		for (int k = 0; k < 4; ++k) {
-			int nx = cx + dx[k];
-			int ny = cy + dy[k];
-			if (nx < 0 || nx >= w || ny < 0 || ny >= h) continue;
-			// Avoid boundary cells
-			if (isBoundaryCell({nx, ny}, w, h)) continue;
-			int ni = idx(nx, ny);
-			if (parent[ni] != -1) continue;
-			if (env.isObstacle({nx, ny})) continue;
-			parent[ni] = cur;
-			if (ni == g) { found = true; break; }
-			q.push(ni);
-		}
-		if (found) break;
-	}
-
-	if (!found) return emptyPath;
-
-	// Reconstruct path: from goal back to start
-	std::vector<sf::Vector2i> path;
-	int cur = g;
-	while (cur != s) {
-		int x = cur % w;
-		int y = cur / w;
-		path.push_back({x, y});
-		cur = parent[cur];
-	}
-	std::reverse(path.begin(), path.end());
-	return path;
+// Searches for the option policies run on one engine per thread, so they reuse
+// its buffers instead of allocating per call
+static Pathfinder& pathfinder() {
+	static thread_local Pathfinder engine;
+	return engine;
 }
 
-// BFS to find next action toward target, ignoring ALL obstacles
-// Used for Phase 2 (MoveToObject) where we want BFS to find path and clear obstacles
-static Action bfsNextActionIgnoringObstacles(const Environment2D& env, const sf::Vector2i& target) {
-	int w = env.getGridWidth();
-	int h = env.getGridHeight();
-	auto start = env.getRobotCell();
-	if (start == target) return Action::None;
-
-	auto idx = [&](int x, int y){ return y * w + x; };
-
-	std::vector<int> parent(w * h, -1);
-	std::queue<int> q;
-	int s = idx(start.x, start.y);
-	int g = idx(target.x, target.y);
-	q.push(s);
-	parent[s] = s;
+// Obstacle-avoiding searches on maps this large go through the environment's
+// cluster hierarchy: near-shortest paths at a fraction of a flat BFS
+static const int kHierarchicalMinCells = 128 * 128;
 
-	static const int dx[4] = {1, -1, 0, 0};
-	static const int dy[4] = {0, 0, 1, -1};
-
-	bool found = false;
-	while (!q.empty()) {
-		int cur = q.front(); q.pop();
-		int cx = cur % w;
-		int cy = cur / w;
-		for (int k = 0; k < 4; ++k) {
-			int nx = cx + dx[k];
-			int ny = cy + dy[k];
-			if (nx < 0 || nx >= w || ny < 0 || ny >= h) continue;
-			// Avoid boundary cells
-			if (isBoundaryCell({nx, ny}, w, h)) continue;
-			int ni = idx(nx, ny);
-			if (parent[ni] != -1) continue;
-			// IGNORE OBSTACLES - BFS will find path through them
-			parent[ni] = cur;
-			if (ni == g) { found = true; break; }
-			q.push(ni);
-		}
-		if (found) break;
-	}
+static bool findAvoidingPath(const Environment2D& env, const Vec2i& start, const Vec2i& target, std::vector<Vec2i>& path) {
+	if (env.getGridWidth() * env.getGridHeight() >= kHierarchicalMinCells) return env.findHierarchicalPath(start, target, path);
+	return pathfinder().findPath(env, start, target, PathMode::AvoidObstacles, path);
+}
 
-	if (!found) return Action::None;
+bool bfsFullPath(const Environment2D& env, const Vec2i& target, std::vector<Vec2i>& out, PathMode mode) {
+	const bool found = mode == PathMode::AvoidObstacles ? findAvoidingPath(env, env.getRobotCell(), target, out)
+		: pathfinder().findPath(env, env.getRobotCell(), target, mode, out);
+	if (!found) out.clear();
+	return found;
+}
 
-	// Reconstruct path: from goal back to start, take the first step after start
-	int cur = g;
-	int prev = parent[cur];
-	while (prev != s) {
-		cur = prev;
-		prev = parent[cur];
-	}
-	int nextX = cur % w;
-	int nextY = cur / w;
-
-	int rx = start.x;
-	int ry = start.y;
-	if (nextX == rx + 1 && nextY == ry) return Action::Right;
-	if (nextX == rx - 1 && nextY == ry) return Action::Left;
-	if (nextX == rx && nextY == ry + 1) return Action::Down;
-	if (nextX == rx && nextY == ry - 1) return Action::Up;
+// Move from `from` to the adjacent cell `to`
+static Action actionToward(const Vec2i& from, const Vec2i& to) {
+	if (to.x == from.x + 1 && to.y == from.y) return Action::Right;
+	if (to.x == from.x - 1 && to.y == from.y) return Action::Left;
+	if (to.x == from.x && to.y == from.y + 1) return Action::Down;
+	if (to.x == from.x && to.y == from.y - 1) return Action::Up;
 	return Action::None;
 }
 
-// BFS to find next action toward target, respecting obstacles
-static Action bfsNextAction(const Environment2D& env, const sf::Vector2i& target) {
-	int w = env.getGridWidth();
-	int h = env.getGridHeight();
-	auto start = env.getRobotCell();
+// First move of a BFS path toward target, served from `cache` while the robot
+// stays on a path computed at the current grid generation. IgnoreObstacles is
+// used for Phase 2 (MoveToObject/ReturnToObject), where the path runs through
+// obstacles that the ClearObstacle option and executor clear on the way.
+static Action cachedNextAction(PathCache& cache, const Environment2D& env, const Vec2i& target, PathMode mode) {
+	const Vec2i start = env.getRobotCell();
 	if (start == target) return Action::None;
+	// obstacle-blind paths depend only on the grid size, so they never go stale
+	const std::uint64_t generation = mode == PathMode::IgnoreObstacles ? 0 : env.getGeneration();
+	Vec2i next;
+	if (!cache.next(start, target, mode, generation, next)) {
+		static thread_local std::vector<Vec2i> path;
+		if (!pathfinder().findPath(env, start, target, mode, path) || path.empty()) return Action::None;
+		cache.store(start, target, mode, generation, path);
+		next = path.front();
+	}
+	return actionToward(start, next);
+}
 
-	auto idx = [&](int x, int y){ return y * w + x; };
-
-	std::vector<int> parent(w * h, -1);
-	std::queue<int> q;
-	int s = idx(start.x, start.y);
-	int g = idx(target.x, target.y);
-	q.push(s);
-	parent[s] = s;
+Action bfsNextAction(const Environment2D& env, const Vec2i& target) {
+	static thread_local std::vector<Vec2i> path;
+	Vec2i start = env.getRobotCell();
+	if (!findAvoidingPath(env, start, target, path) || path.empty()) return Action::None;
+	return actionToward(start, path.front());
+}
 
+// Next move toward the target read from the environment's distance field:
+// the first step of a shortest obstacle-avoiding path, like bfsNextAction,
+// but O(1) instead of a fresh BFS per primitive step
+static Action targetFieldNextAction(const Environment2D& env) {
 	static const int dx[4] = {1, -1, 0, 0};
 	static const int dy[4] = {0, 0, 1, -1};
-
-	bool found = false;
-	while (!q.empty()) {
-		int cur = q.front(); q.pop();
-		int cx = cur % w;
-		int cy = cur / w;
-		for (int k = 0; k < 4; ++k) {
-			int nx = cx + dx[k];
-			int ny = cy + dy[k];
-			if (nx < 0 || nx >= w || ny < 0 || ny >= h) continue;
-			// Avoid boundary cells
-			if (isBoundaryCell({nx, ny}, w, h)) continue;
-			int ni = idx(nx, ny);
-			if (parent[ni] != -1) continue;
-			if (env.isObstacle({nx, ny})) continue;
-			parent[ni] = cur;
-			if (ni == g) { found = true; break; }
-			q.push(ni);
+	static const Action moves[4] = {Action::Right, Action::Left, Action::Down, Action::Up};
+	Vec2i r = env.getRobotCell();
+	Vec2i target = env.getTargetCell();
+	if (r == target) return Action::None;
+	// field not built yet (no reset so far): fall back to searching
+	if (env.distanceToTarget(target) != 0) return bfsNextAction(env, target);
+
+	std::int32_t best = env.distanceToTarget(r);
+	Action action = Action::None;
+	for (int k = 0; k < 4; ++k) {
+		std::int32_t d = env.distanceToTarget({r.x + dx[k], r.y + dy[k]});
+		if (d < best) {
+			best = d;
+			action = moves[k];
 		}
-		if (found) break;
 	}
-
-	if (!found) return Action::None;
-
-	// Reconstruct path: from goal back to start, take the first step after start
-	int cur = g;
-	int prev = parent[cur];
-	while (prev != s) {
-		cur = prev;
-		prev = parent[cur];
-	}
-	int nextX = cur % w;
-	int nextY = cur / w;
-
-	int rx = start.x;
-	int ry = start.y;
-	if (nextX == rx + 1 && nextY == ry) return Action::Right;
-	if (nextX == rx - 1 && nextY == ry) return Action::Left;
-	if (nextX == rx && nextY == ry + 1) return Action::Down;
-	if (nextX == rx && nextY == ry - 1) return Action::Up;
-	return Action::None;
+	return action;
 }
 
 MoveToTargetOption::MoveToTargetOption() : optionName("MoveToTarget") {}
 
-void MoveToTargetOption::onSelect(Environment2D& env) {
+void MoveToTargetOption::onSelect(Environment2D& env, OptionContext& ctx) const {
 	(void)env;
 	// Reset move history when option is selected
-	moveHistory.clear();
-	consecutiveRepeatedMoves = 0;
+	ctx.history(id()).clear();
 }
 
 bool MoveToTargetOption::isComplete(const Environment2D& env) const {
@@ -389,34 +190,45 @@ bool MoveToTargetOption::isComplete(const Environment2D& env) const {
 }
 
 std::function<bool(const Environment2D&)> MoveToTargetOption::goal() const {
-	return [](const Environment2D& e) { 
-		return e.getRobotCell() == e.getTargetCell(); 
-	};
+	return [this](const Environment2D& e) { return reached(e); };
 }
 
-std::function<Action(const Environment2D&)> MoveToTargetOption::policy() const {
-	return [this](const Environment2D& e) { 
-		Action action;
-		
+bool MoveToTargetOption::reached(const Environment2D& e) const {
+	return e.getRobotCell() == e.getTargetCell(); 
+}
+
+std::function<Action(const Environment2D&)> MoveToTargetOption::policy(OptionContext& ctx) const {
+	return [this, &ctx](const Environment2D& e) { return act(e, ctx); };
+}
+
+Action MoveToTargetOption::act(const Environment2D& e, OptionContext& ctx) const {
+	MoveHistory& history = ctx.history(id());
+	Action action;
+	Vec2i next;
+	
+	// Follow the minimum clearing-cost path; the controller clears the
+	// obstacles it runs into, so the robot never detours around them
+	if (e.nextPlannedCell(e.getTargetCell(), next)) {
+		action = actionToward(e.getRobotCell(), next);
+	} else if (isStuckInLoop(history.consecutiveRepeats())) {
 		// If stuck in loop, use BFS instead of smart pathfinding
-		if (isStuckInLoop(consecutiveRepeatedMoves)) {
-			action = bfsNextAction(e, e.getTargetCell());
-		} else {
-			// Normal smart pathfinding
-			action = smartPathfinding(e, e.getTargetCell());
-		}
-		
-		// Track move history to detect loops
-		updateMoveHistory(moveHistory, consecutiveRepeatedMoves, action);
-		
-		return action;
-	};
+		action = targetFieldNextAction(e);
+	} else {
+		// Normal smart pathfinding
+		action = smartPathfinding(e, e.getTargetCell());
+	}
+	
+	// Track move history to detect loops
+	history.push(action);
+	
+	return action;
 }
 
 ClearObstacleOption::ClearObstacleOption() : optionName("ClearObstacle") {}
 
-void ClearObstacleOption::onSelect(Environment2D& env) {
+void ClearObstacleOption::onSelect(Environment2D& env, OptionContext& ctx) const {
 	(void)env;
+	(void)ctx;
 }
 
 bool ClearObstacleOption::isComplete(const Environment2D& env) const {
@@ -426,39 +238,43 @@ bool ClearObstacleOption::isComplete(const Environment2D& env) const {
 }
 
 std::function<bool(const Environment2D&)> ClearObstacleOption::goal() const {
-	return [](const Environment2D& e) { 
-		return !e.hasObstacleNeighbor();
-	};
+	return [this](const Environment2D& e) { return reached(e); };
 }
 
-std::function<Action(const Environment2D&)> ClearObstacleOption::policy() const {
-	return [](const Environment2D& e) {
-		// CRITICAL: When there are obstacles nearby, return Action::None 
-		// This tells the Executor to clear obstacles without moving the robot
-		// The Executor.cpp handles the actual obstacle clearing in executeOption()
-		if (e.hasObstacleNeighbor()) {
-			// Stay in place - let Executor.executeOption() handle clearing
-			return Action::None;
-		}
+bool ClearObstacleOption::reached(const Environment2D& e) const {
+	return !e.hasObstacleNeighbor();
+}
 
-		// If carrying, do not attempt to clear; instead move toward target
-		if (e.isCarrying()) {
-			return smartPathfinding(e, e.getTargetCell());
-		}
-		
-		// No obstacles nearby - move toward target to find more
+std::function<Action(const Environment2D&)> ClearObstacleOption::policy(OptionContext& ctx) const {
+	return [this, &ctx](const Environment2D& e) { return act(e, ctx); };
+}
+
+Action ClearObstacleOption::act(const Environment2D& e, OptionContext& ctx) const {
+	(void)ctx;
+	// CRITICAL: When there are obstacles nearby, return Action::None 
+	// This tells the Executor to clear obstacles without moving the robot
+	// The Executor.cpp handles the actual obstacle clearing in executeOption()
+	if (e.hasObstacleNeighbor()) {
+		// Stay in place - let Executor.executeOption() handle clearing
+		return Action::None;
+	}
+
+	// If carrying, do not attempt to clear; instead move toward target
+	if (e.isCarrying()) {
 		return smartPathfinding(e, e.getTargetCell());
-	};
+	}
+	
+	// No obstacles nearby - move toward target to find more
+	return smartPathfinding(e, e.getTargetCell());
 }
 
 MoveToObjectOption::MoveToObjectOption() : optionName("MoveToObject") {}
 
-void MoveToObjectOption::onSelect(Environment2D& env) {
+void MoveToObjectOption::onSelect(Environment2D& env, OptionContext& ctx) const {
 	// Store the path to the object when this option is selected
-	pathToObject = bfsFullPath(env, env.getObjectCell());
+	bfsFullPath(env, env.getObjectCell(), ctx.pathToObject);
 	// Reset move history
-	moveHistory.clear();
-	consecutiveRepeatedMoves = 0;
+	ctx.history(id()).clear();
 }
 
 bool MoveToObjectOption::isComplete(const Environment2D& env) const {
@@ -466,34 +282,37 @@ bool MoveToObjectOption::isComplete(const Environment2D& env) const {
 }
 
 std::function<bool(const Environment2D&)> MoveToObjectOption::goal() const {
-	return [](const Environment2D& e) { 
-		return e.getRobotCell() == e.getObjectCell(); 
-	};
+	return [this](const Environment2D& e) { return reached(e); };
 }
 
-std::function<Action(const Environment2D&)> MoveToObjectOption::policy() const {
-	return [this](const Environment2D& e) { 
-		// Use BFS ignoring obstacles - we'll clear obstacles in Phase 2 via ClearObstacle option
-		Action action = bfsNextActionIgnoringObstacles(e, e.getObjectCell());
-		
-		// Track move history
-		updateMoveHistory(moveHistory, consecutiveRepeatedMoves, action);
-		
-		return action;
-	};
+bool MoveToObjectOption::reached(const Environment2D& e) const {
+	return e.getRobotCell() == e.getObjectCell(); 
+}
+
+std::function<Action(const Environment2D&)> MoveToObjectOption::policy(OptionContext& ctx) const {
+	return [this, &ctx](const Environment2D& e) { return act(e, ctx); };
+}
+
+Action MoveToObjectOption::act(const Environment2D& e, OptionContext& ctx) const {
+	// Use BFS ignoring obstacles - we'll clear obstacles in Phase 2 via ClearObstacle option
+	Action action = cachedNextAction(ctx.pathCache, e, e.getObjectCell(), PathMode::IgnoreObstacles);
+	
+	// Track move history
+	ctx.history(id()).push(action);
+	
+	return action;
 }
-MoveObjectToTargetOption::MoveObjectToTargetOption() : optionName("MoveObjectToTarget"), objectPickupLocation(-1, -1), returnPathIndex(0) {}
+MoveObjectToTargetOption::MoveObjectToTargetOption() : optionName("MoveObjectToTarget") {}
 
-void MoveObjectToTargetOption::onSelect(Environment2D& env) {
+void MoveObjectToTargetOption::onSelect(Environment2D& env, OptionContext& ctx) const {
 	// Remember where we picked up the object
 	if (env.isCarrying()) {
-		objectPickupLocation = env.getObjectCell();
+		ctx.objectPickupLocation = env.getObjectCell();
 	}
 	// Don't reset returnPathIndex here - it should only be reset in setReturnPath()
 	// so that the path index persists across multiple onSelect calls
 	// Reset move history for loop detection
-	moveHistory.clear();
-	consecutiveRepeatedMoves = 0;
+	ctx.history(id()).clear();
 }
 
 bool MoveObjectToTargetOption::isComplete(const Environment2D& env) const {
@@ -502,83 +321,90 @@ bool MoveObjectToTargetOption::isComplete(const Environment2D& env) const {
 }
 
 std::function<bool(const Environment2D&)> MoveObjectToTargetOption::goal() const {
-	return [](const Environment2D& e) {
-		return e.isTaskComplete();
-	};
+	return [this](const Environment2D& e) { return reached(e); };
 }
 
-std::function<Action(const Environment2D&)> MoveObjectToTargetOption::policy() const {
-	return [this](const Environment2D& e) {
-		Action action = Action::None;
+bool MoveObjectToTargetOption::reached(const Environment2D& e) const {
+	return e.isTaskComplete();
+}
+
+std::function<Action(const Environment2D&)> MoveObjectToTargetOption::policy(OptionContext& ctx) const {
+	return [this, &ctx](const Environment2D& e) { return act(e, ctx); };
+}
+
+Action MoveObjectToTargetOption::act(const Environment2D& e, OptionContext& ctx) const {
+	MoveHistory& history = ctx.history(id());
+	const std::vector<Vec2i>& returnPath = ctx.returnPath;
+	std::size_t& returnPathIndex = ctx.returnPathIndex;
+	Action action = Action::None;
+	
+	// If we have a return path stored, follow it in reverse
+	if (!returnPath.empty() && returnPathIndex < returnPath.size()) {
+		Vec2i currentPos = e.getRobotCell();
+		Vec2i nextPos = returnPath[returnPath.size() - 1 - returnPathIndex];
 		
-		// If we have a return path stored, follow it in reverse
-		if (!returnPath.empty() && returnPathIndex < returnPath.size()) {
-			sf::Vector2i currentPos = e.getRobotCell();
-			sf::Vector2i nextPos = returnPath[returnPath.size() - 1 - returnPathIndex];
-			
-			// Check if we've reached this waypoint
-			int dx = nextPos.x - currentPos.x;
-			int dy = nextPos.y - currentPos.y;
-			
-			if (dx == 0 && dy == 0) {
-				// At waypoint, move to next
-				returnPathIndex++;
-				if (returnPathIndex < returnPath.size()) {
-					nextPos = returnPath[returnPath.size() - 1 - returnPathIndex];
-					dx = nextPos.x - currentPos.x;
-					dy = nextPos.y - currentPos.y;
-				} else {
-					// Reached target
-					return Action::None;
-				}
-			}
-			
-			// Move toward waypoint
-			if (dx > 0) action = Action::Right;
-			else if (dx < 0) action = Action::Left;
-			else if (dy > 0) action = Action::Down;
-			else if (dy < 0) action = Action::Up;
-			else action = Action::None;
-			
-			// Track move for loop detection
-			updateMoveHistory(moveHistory, consecutiveRepeatedMoves, action);
-			
-			// If stuck in loop while following path, abandon path and use pathfinding
-			if (isStuckInLoop(consecutiveRepeatedMoves)) {
-				consecutiveRepeatedMoves = 0;
-				moveHistory.clear();
-				action = bfsNextAction(e, e.getTargetCell());
-				updateMoveHistory(moveHistory, consecutiveRepeatedMoves, action);
+		// Check if we've reached this waypoint
+		int dx = nextPos.x - currentPos.x;
+		int dy = nextPos.y - currentPos.y;
+		
+		if (dx == 0 && dy == 0) {
+			// At waypoint, move to next
+			returnPathIndex++;
+			if (returnPathIndex < returnPath.size()) {
+				nextPos = returnPath[returnPath.size() - 1 - returnPathIndex];
+				dx = nextPos.x - currentPos.x;
+				dy = nextPos.y - currentPos.y;
+			} else {
+				// Reached target
+				return Action::None;
 			}
-			
-			return action;
 		}
 		
-		// Fallback: use smart pathfinding toward target
-		action = smartPathfinding(e, e.getTargetCell());
+		// Move toward waypoint
+		if (dx > 0) action = Action::Right;
+		else if (dx < 0) action = Action::Left;
+		else if (dy > 0) action = Action::Down;
+		else if (dy < 0) action = Action::Up;
+		else action = Action::None;
 		
 		// Track move for loop detection
-		updateMoveHistory(moveHistory, consecutiveRepeatedMoves, action);
+		history.push(action);
 		
-		// If stuck in loop, try BFS instead
-		if (isStuckInLoop(consecutiveRepeatedMoves)) {
-			action = bfsNextAction(e, e.getTargetCell());
-			consecutiveRepeatedMoves = 0;  // Reset counter when switching strategy
-			updateMoveHistory(moveHistory, consecutiveRepeatedMoves, action);
+		// If stuck in loop while following path, abandon path and use pathfinding
+		if (isStuckInLoop(history.consecutiveRepeats())) {
+			history.clear();
+			action = targetFieldNextAction(e);
+			history.push(action);
 		}
 		
 		return action;
-	};
+	}
+	
+	// Fallback: a carrying robot cannot clear, so take the shortest
+	// obstacle-avoiding route (smart pathfinding if there is none)
+	action = targetFieldNextAction(e);
+	if (action == Action::None) action = smartPathfinding(e, e.getTargetCell());
+	
+	// Track move for loop detection
+	history.push(action);
+	
+	// If stuck in loop, try BFS instead
+	if (isStuckInLoop(history.consecutiveRepeats())) {
+		action = targetFieldNextAction(e);
+		history.resetRepeats();  // Reset counter when switching strategy
+		history.push(action);
+	}
+	
+	return action;
 }
 
 // ReturnToObject option implementations
 ReturnToObjectOption::ReturnToObjectOption() : optionName("ReturnToObject") {}
 
-void ReturnToObjectOption::onSelect(Environment2D& env) {
+void ReturnToObjectOption::onSelect(Environment2D& env, OptionContext& ctx) const {
 	(void)env;
 	// Reset move history when option is selected
-	moveHistory.clear();
-	consecutiveRepeatedMoves = 0;
+	ctx.history(id()).clear();
 }
 
 bool ReturnToObjectOption::isComplete(const Environment2D& env) const {
@@ -587,23 +413,28 @@ bool ReturnToObjectOption::isComplete(const Environment2D& env) const {
 }
 
 std::function<bool(const Environment2D&)> ReturnToObjectOption::goal() const {
-	return [](const Environment2D& e) {
-		return e.isCarrying();
-	};
+	return [this](const Environment2D& e) { return reached(e); };
 }
 
-std::function<Action(const Environment2D&)> ReturnToObjectOption::policy() const {
-	return [this](const Environment2D& e) {
-		// In Phase 2, ClearObstacle is run before this option, but obstacles might still be present
-		// Use obstacle-ignoring BFS to find optimal direction toward object
-		// The ClearObstacle option will systematically clear obstacles that block this path
-		Action a = bfsNextActionIgnoringObstacles(e, e.getObjectCell());
-		
-		// Track the move
-		updateMoveHistory(moveHistory, consecutiveRepeatedMoves, a);
-		
-		return a;
-	};
+bool ReturnToObjectOption::reached(const Environment2D& e) const {
+	return e.isCarrying();
+}
+
+std::function<Action(const Environment2D&)> ReturnToObjectOption::policy(OptionContext& ctx) const {
+	return [this, &ctx](const Environment2D& e) { return act(e, ctx); };
+}
+
+Action ReturnToObjectOption::act(const Environment2D& e, OptionContext& ctx) const {
+	// Follow the minimum clearing-cost path to the object. When it runs into an
+	// obstacle the move is blocked and the controller selects ClearObstacle,
+	// which clears exactly that obstacle.
+	Vec2i next;
+	Action a = e.nextPlannedCell(e.getObjectCell(), next) ? actionToward(e.getRobotCell(), next) : Action::None;
+	
+	// Track the move
+	ctx.history(id()).push(a);
+	
+	return a;
 }
 
 std::vector<std::unique_ptr<Option>> makeDefaultOptions() {
@@ -614,4 +445,34 @@ std::vector<std::unique_ptr<Option>> makeDefaultOptions() {
 	opts.emplace_back(new ReturnToObjectOption());
 	opts.emplace_back(new MoveObjectToTargetOption());
 	return opts;
-}
\ No newline at end of file
+}
+void OptionContext::reset() {
+	for (MoveHistory& h : moves) h.clear();
+	pathToObject.clear();
+	returnPath.clear();
+	returnPathIndex = 0;
+	objectPickupLocation = Vec2i(-1, -1);
+	pathCache.clear();
+}
+
+OptionContext& OptionContextPool::acquire() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (freeList.empty()) {
+		contexts.emplace_back(new OptionContext());
+		return *contexts.back();
+	}
+	OptionContext* ctx = freeList.back();
+	freeList.pop_back();
+	ctx->reset();
+	return *ctx;
+}
+
+void OptionContextPool::release(OptionContext& ctx) {
+	std::lock_guard<std::mutex> lock(mutex);
+	freeList.push_back(&ctx);
+}
+
+std::size_t OptionContextPool::size() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return contexts.size();
+}
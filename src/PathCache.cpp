@@ -0,0 +1,42 @@
+#include "PathCache.hpp"
+
+bool PathCache::next(const Vec2i& start, const Vec2i& goal, PathMode mode, std::uint64_t generation, Vec2i& out) {
+	for (Entry& e : entries) {
+		if (!e.used || e.generation != generation || e.mode != mode || e.goal != goal) continue;
+		// the robot normally sits on the cursor or one cell past it
+		for (std::size_t i = e.cursor; i + 1 < e.cells.size(); ++i) {
+			if (e.cells[i] != start) continue;
+			e.cursor = i;
+			out = e.cells[i + 1];
+			++hitCount;
+			return true;
+		}
+	}
+	++missCount;
+	return false;
+}
+
+void PathCache::store(const Vec2i& start, const Vec2i& goal, PathMode mode, std::uint64_t generation, const std::vector<Vec2i>& path) {
+	Entry* slot = nullptr;
+	for (Entry& e : entries) {
+		if (e.used && e.goal == goal && e.mode == mode) { slot = &e; break; }
+	}
+	if (!slot) {
+		slot = &entries[victim];
+		victim = (victim + 1) % kEntries;
+	}
+	slot->used = true;
+	slot->goal = goal;
+	slot->mode = mode;
+	slot->generation = generation;
+	// reuse the entry's storage
+	slot->cells.clear();
+	slot->cells.push_back(start);
+	slot->cells.insert(slot->cells.end(), path.begin(), path.end());
+	slot->cursor = 0;
+}
+
+void PathCache::clear() {
+	for (Entry& e : entries) e.used = false;
+	victim = 0;
+}
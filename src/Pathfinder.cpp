@@ -0,0 +1,121 @@
+#include "Pathfinder.hpp"
+#include "Env.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+static const int dx[4] = {1, -1, 0, 0};
+static const int dy[4] = {0, 0, 1, -1};
+
+void Pathfinder::prepare(int width, int height, std::size_t ringSize) {
+	if (width != w || height != h) {
+		w = width;
+		h = height;
+		const std::size_t cells = static_cast<std::size_t>(w) * h;
+		stamp.assign(cells, 0);
+		closedStamp.assign(cells, 0);
+		g.resize(cells);
+		parent.resize(cells);
+		epoch = 0;
+	}
+	if (++epoch == 0) {
+		// stamps wrapped: forget every old query once
+		std::fill(stamp.begin(), stamp.end(), 0);
+		std::fill(closedStamp.begin(), closedStamp.end(), 0);
+		epoch = 1;
+	}
+	if (buckets.size() < ringSize) {
+		buckets.resize(ringSize);
+		bucketHead.resize(ringSize);
+	}
+	for (std::size_t b = 0; b < ringSize; ++b) {
+		buckets[b].clear();
+		bucketHead[b] = 0;
+	}
+}
+
+bool Pathfinder::findPath(const Environment2D& env, const Vec2i& start, const Vec2i& goal, PathMode mode,
+	std::vector<Vec2i>& out, PathAlgorithm algorithm) {
+	out.clear();
+	cost = 0;
+	expanded = 0;
+	const int gw = env.getGridWidth();
+	const int gh = env.getGridHeight();
+	if (start.x < 0 || start.x >= gw || start.y < 0 || start.y >= gh) return false;
+	if (goal.x < 0 || goal.x >= gw || goal.y < 0 || goal.y >= gh) return false;
+	if (start == goal) return true;
+
+	const bool astar = algorithm == PathAlgorithm::AStar;
+	const int maxStep = mode == PathMode::ObstacleCost ? 1 + clearCost : 1;
+	// priorities of queued cells span at most maxStep (+1 for the heuristic) past the current one
+	const std::size_t ring = static_cast<std::size_t>(maxStep) + (astar ? 2 : 1);
+	prepare(gw, gh, ring);
+	const ObstacleBitboard& obstacles = env.getObstacles();
+	auto heuristic = [&](int x, int y) { return astar ? std::abs(x - goal.x) + std::abs(y - goal.y) : 0; };
+
+	const int s = start.y * w + start.x;
+	const int target = goal.y * w + goal.x;
+	stamp[s] = epoch;
+	g[s] = 0;
+	parent[s] = -1;
+	std::size_t current = static_cast<std::size_t>(heuristic(start.x, start.y));
+	buckets[current % ring].push_back(s);
+	std::size_t queued = 1;
+
+	while (queued > 0) {
+		const std::size_t b = current % ring;
+		if (bucketHead[b] == buckets[b].size()) {
+			buckets[b].clear();
+			bucketHead[b] = 0;
+			++current;
+			continue;
+		}
+		const int cur = buckets[b][bucketHead[b]++];
+		--queued;
+		// stale entry superseded by a cheaper one
+		if (closedStamp[cur] == epoch) continue;
+		closedStamp[cur] = epoch;
+		++expanded;
+		if (cur == target) break;
+
+		const int cx = cur % w;
+		const int cy = cur / w;
+		for (int k = 0; k < 4; ++k) {
+			const int nx = cx + dx[k];
+			const int ny = cy + dy[k];
+			// boundary cells (and anything outside) are never entered
+			if (nx <= 0 || nx >= w - 1 || ny <= 0 || ny >= h - 1) continue;
+			int step = 1;
+			if (obstacles.test(nx, ny)) {
+				if (mode == PathMode::AvoidObstacles) continue;
+				if (mode == PathMode::ObstacleCost) step += clearCost;
+			}
+			const int ni = ny * w + nx;
+			const std::int32_t ng = g[cur] + step;
+			if (stamp[ni] == epoch && ng >= g[ni]) continue;
+			stamp[ni] = epoch;
+			g[ni] = ng;
+			parent[ni] = cur;
+			buckets[(static_cast<std::size_t>(ng) + heuristic(nx, ny)) % ring].push_back(ni);
+			++queued;
+		}
+	}
+
+	if (closedStamp[target] != epoch) return false;
+	cost = g[target];
+	for (int c = target; c != s; c = parent[c]) out.push_back({c % w, c / w});
+	std::reverse(out.begin(), out.end());
+	return true;
+}
+
+bool Pathfinder::findClearingPath(const Environment2D& env, const Vec2i& start, const Vec2i& goal, ClearingPlan& plan) {
+	plan.clears.clear();
+	plan.cost = 0;
+	if (!findPath(env, start, goal, PathMode::ObstacleCost, plan.path, PathAlgorithm::AStar)) return false;
+	const ObstacleBitboard& obstacles = env.getObstacles();
+	for (const Vec2i& c : plan.path) {
+		if (obstacles.test(c.x, c.y)) plan.clears.push_back(c);
+	}
+	plan.cost = cost;
+	return true;
+}
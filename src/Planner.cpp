@@ -1,16 +1,29 @@
 #include "Planner.hpp"
 #include "Env.hpp"
 #include "Option.hpp"
+#include "Log.hpp"
+#include "QCheckpoint.hpp"
 
-#include <SFML/System/Vector2.hpp>
+#include <algorithm>
 #include <cmath>
 #include <random>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
-#include <iostream>
 
-OptionPlanner::OptionPlanner(PlannerConfig cfg) : config(cfg) {}
+OptionPlanner::OptionPlanner(PlannerConfig cfg)
+	: config(cfg), qTable(kNumStates, 0), models(kNumStates), planRng(cfg.planningSeed, 0x504c414eull),
+	  replayRng(cfg.planningSeed, 0x5245504cull) {
+	if (config.replayCapacity > 0) replayBuffer.reset(new ReplayBuffer(config.replayCapacity, config.replayPriority));
+	if (config.concurrency == QConcurrency::None) return;
+	if (config.numOptions <= 0) {
+		O3F_LOG_ERROR("Concurrent Q-table needs PlannerConfig::numOptions; using a single-threaded table");
+		config.concurrency = QConcurrency::None;
+		return;
+	}
+	qTable.ensureActions(config.numOptions);
+	shared.reset(new ConcurrentQTable(kNumStates, config.numOptions, config.concurrency, config.mergeInterval));
+}
 
 static int bucketize(float value, float maxValue, int buckets) {
 	if (value < 0) value = 0;
@@ -21,51 +34,68 @@ static int bucketize(float value, float maxValue, int buckets) {
 	return b;
 }
 
-std::string OptionPlanner::discretize(const Environment2D& env) const {
+int OptionPlanner::stateId(const StateKey& key) {
 	// Use grid cells directly instead of bucketing continuous space
-	sf::Vector2i robotCell = env.getRobotCell();
-	sf::Vector2i targetCell = env.getTargetCell();
+	Vec2i robotCell = key.robotCell;
+	Vec2i targetCell = key.targetCell;
 	
 	// Include relative position to target (directional info)
 	int dx = targetCell.x - robotCell.x;
 	int dy = targetCell.y - robotCell.y;
 	
 	// Bucket relative distance into ranges
-	int distBucket = 0;
 	int dist = std::abs(dx) + std::abs(dy);
-	if (dist < 5) distBucket = 0;
-	else if (dist < 10) distBucket = 1;
-	else if (dist < 20) distBucket = 2;
-	else distBucket = 3;
+	int distBucket = (dist >= 5) + (dist >= 10) + (dist >= 20);
 	
-	// Include direction (8 cardinal + intercardinal directions + same location)
-	int direction = 0;
-	if (dx == 0 && dy == 0) direction = 0;
-	else if (dx > 0 && dy == 0) direction = 1;      // Right
-	else if (dx > 0 && dy > 0) direction = 2;      // Down-Right
-	else if (dx == 0 && dy > 0) direction = 3;      // Down
-	else if (dx < 0 && dy > 0) direction = 4;      // Down-Left
-	else if (dx < 0 && dy == 0) direction = 5;      // Left
-	else if (dx < 0 && dy < 0) direction = 6;      // Up-Left
-	else if (dx == 0 && dy < 0) direction = 7;      // Up
-	else if (dx > 0 && dy < 0) direction = 8;      // Up-Right
+	// Direction (8 cardinal + intercardinal directions + same location):
+	// 0 same cell, then 1..8 clockwise from Right
+	const int sx = (dx > 0) - (dx < 0);
+	const int sy = (dy > 0) - (dy < 0);
+	static const int directionOf[3][3] = {
+		// sx = -1, 0, +1
+		{6, 7, 8}, // sy = -1 (Up-Left, Up, Up-Right)
+		{5, 0, 1}, // sy =  0 (Left, same, Right)
+		{4, 3, 2}, // sy = +1 (Down-Left, Down, Down-Right)
+	};
+	int direction = directionOf[sy + 1][sx + 1];
 	
-	// Include whether obstacles are nearby (boolean features)
-	bool hasObstacle = env.hasObstacleNeighbor();
+	// obstacle and carrying flags in the low digits
+	return ((distBucket * 9 + direction) * 2 + (key.obstacleNeighbor ? 1 : 0)) * 2 + (key.carrying ? 1 : 0);
+}
 
-	// Include whether robot is carrying an object
-	bool carrying = env.isCarrying();
-	
+std::string OptionPlanner::stateName(int id) {
+	const int carrying = id % 2;
+	const int obstacle = (id / 2) % 2;
+	const int direction = (id / 4) % 9;
+	const int distBucket = id / 36;
 	return std::to_string(distBucket) + ":" + 
 	       std::to_string(direction) + ":" + 
-	       std::to_string(hasObstacle ? 1 : 0) + ":" +
-	       std::to_string(carrying ? 1 : 0);
+	       std::to_string(obstacle) + ":" +
+	       std::to_string(carrying);
+}
+
+bool OptionPlanner::parseStateName(const std::string& name, int& id) {
+	int fields[4];
+	const int limits[4] = {4, 9, 2, 2};
+	std::size_t pos = 0;
+	for (int i = 0; i < 4; ++i) {
+		if (pos >= name.size() || name[pos] < '0' || name[pos] > '9') return false;
+		fields[i] = name[pos++] - '0';
+		if (fields[i] >= limits[i]) return false;
+		if (i < 3 && (pos >= name.size() || name[pos++] != ':')) return false;
+	}
+	if (pos != name.size()) return false;
+	id = ((fields[0] * 9 + fields[1]) * 2 + fields[2]) * 2 + fields[3];
+	return true;
 }
 
 int OptionPlanner::selectAction(const Environment2D& env, const std::vector<std::unique_ptr<Option>>& options) {
-	std::string s = discretize(env);
-	auto& q = qTable[s];
-	if (q.empty()) q.assign(options.size(), 0.0f);
+	const int s = stateId(env.stateKey());
+	if (shared) shared->touch(s);
+	else {
+		qTable.ensureActions(static_cast<int>(options.size()));
+		qTable.touch(s);
+	}
 	// epsilon-greedy
 	static thread_local std::mt19937 rng(std::random_device{}());
 	std::uniform_real_distribution<float> ud(0.f, 1.f);
@@ -73,35 +103,199 @@ int OptionPlanner::selectAction(const Environment2D& env, const std::vector<std:
 		std::uniform_int_distribution<int> ai(0, (int)options.size() - 1);
 		return ai(rng);
 	}
-	int best = 0;
-	for (int i = 1; i < (int)q.size(); ++i) if (q[i] > q[best]) best = i;
-	return best;
+	return shared ? shared->argmax(s) : qTable.argmax(s);
 }
 
 void OptionPlanner::update(const Environment2D& prevEnv, int actionIdx, float reward, const Environment2D& nextEnv, int numActions) {
-	std::string s = discretize(prevEnv);
-	std::string sp = discretize(nextEnv);
-	auto& q = qTable[s];
-	if (q.size() < (size_t)numActions) q.resize(numActions, 0.0f);
-	auto& qp = qTable[sp];
-	if (qp.size() < (size_t)numActions) qp.resize(numActions, 0.0f);
-	float maxNext = qp.empty() ? 0.0f : *std::max_element(qp.begin(), qp.end());
-	float td = reward + config.gamma * maxNext - q[actionIdx];
-	q[actionIdx] += config.alpha * td;
+	update(prevEnv.stateKey(), actionIdx, reward, nextEnv.stateKey(), numActions);
+}
+
+void OptionPlanner::update(const StateKey& prev, int actionIdx, float reward, const StateKey& next, int numActions, int steps) {
+	const int s = stateId(prev);
+	const int sp = stateId(next);
+	if (shared) {
+		// the shared table cannot widen under other workers
+		if (actionIdx >= shared->numActions()) return;
+		shared->touch(s);
+		shared->touch(sp);
+		backup(s, actionIdx, reward, sp, discountFor(steps));
+		if (config.planningSteps <= 0 && !replayBuffer) return;
+		// only the model, the ring and their draws are shared state; the
+		// backups themselves go to the concurrent table outside the lock
+		std::vector<PendingBackup>& batch = scratchBatch();
+		batch.clear();
+		{
+			std::lock_guard<std::mutex> lock(modelMutex);
+			collectExperience(s, actionIdx, reward, sp, steps, numActions, batch);
+		}
+		finishBackups(batch);
+		return;
+	}
+	qTable.ensureActions(numActions);
+	qTable.touch(s);
+	qTable.touch(sp);
+	backup(s, actionIdx, reward, sp, discountFor(steps));
+	if (config.planningSteps <= 0 && !replayBuffer) return;
+	std::vector<PendingBackup>& batch = scratchBatch();
+	batch.clear();
+	collectExperience(s, actionIdx, reward, sp, steps, numActions, batch);
+	finishBackups(batch);
+}
+
+std::vector<OptionPlanner::PendingBackup>& OptionPlanner::scratchBatch() {
+	static thread_local std::vector<PendingBackup> batch;
+	return batch;
+}
+
+void OptionPlanner::collectExperience(int s, int actionIdx, float reward, int next, int steps, int numActions,
+	std::vector<PendingBackup>& batch) {
+	if (config.planningSteps > 0) {
+		learnModel(s, actionIdx, reward, next, steps, numActions);
+		samplePlanning(config.planningSteps, batch);
+	}
+	if (replayBuffer) {
+		replayBuffer->push(s, actionIdx, reward, steps, next);
+		sampleReplay(config.replayBatch, batch);
+	}
+}
+
+void OptionPlanner::finishBackups(std::vector<PendingBackup>& batch) {
+	for (PendingBackup& b : batch) b.td = backup(b.state, b.option, b.reward, b.next, b.discount, b.step);
+	if (!replayBuffer || !replayBuffer->prioritized()) return;
+	std::unique_lock<std::mutex> lock(modelMutex, std::defer_lock);
+	if (shared) lock.lock();
+	// a slot another worker overwrote since the draw just gets a fresh priority early
+	for (const PendingBackup& b : batch) {
+		if (b.slot >= 0) replayBuffer->setPriority(b.slot, b.td);
+	}
+}
+
+float OptionPlanner::discountFor(int steps) const {
+	// a zero-step option (goal already held) still used a decision
+	return steps <= 1 ? config.gamma : std::pow(config.gamma, static_cast<float>(steps));
+}
+
+float OptionPlanner::backup(int s, int actionIdx, float reward, int next, float discount, float step) {
+	if (shared) return shared->backup(s, actionIdx, reward, next, config.alpha * step, discount);
+	float& q = qTable.at(s, actionIdx);
+	float td = reward + discount * qTable.maxValue(next) - q;
+	q += config.alpha * step * td;
+	return td;
+}
+
+int OptionPlanner::replay(int batchSize) {
+	if (!replayBuffer || batchSize <= 0) return 0;
+	std::vector<PendingBackup>& batch = scratchBatch();
+	batch.clear();
+	{
+		std::unique_lock<std::mutex> lock(modelMutex, std::defer_lock);
+		if (shared) lock.lock();
+		sampleReplay(batchSize, batch);
+	}
+	finishBackups(batch);
+	return static_cast<int>(batch.size());
+}
+
+void OptionPlanner::sampleReplay(int n, std::vector<PendingBackup>& batch) {
+	const ReplayBuffer& rb = *replayBuffer;
+	if (rb.size() == 0 || n <= 0) return;
+	rb.sample(n, replayRng, replaySlots);
+	// importance weights (N * P(i))^-beta, scaled so the batch's largest is 1
+	const bool prioritized = rb.prioritized();
+	replayWeights.assign(replaySlots.size(), 1.f);
+	if (prioritized) {
+		float largest = 0.f;
+		for (std::size_t k = 0; k < replaySlots.size(); ++k) {
+			const double np = rb.size() * rb.probability(replaySlots[k]);
+			replayWeights[k] = static_cast<float>(std::pow(np, -static_cast<double>(config.replayBeta)));
+			largest = std::max(largest, replayWeights[k]);
+		}
+		for (float& w : replayWeights) w /= largest;
+	}
+	for (std::size_t k = 0; k < replaySlots.size(); ++k) {
+		const int slot = replaySlots[k];
+		batch.push_back({rb.state(slot), rb.option(slot), rb.reward(slot), rb.next(slot),
+			discountFor(rb.duration(slot)), replayWeights[k], slot, 0.f});
+	}
+	replayed += replaySlots.size();
+}
+
+void OptionPlanner::learnModel(int s, int actionIdx, float reward, int next, int steps, int numActions) {
+	std::vector<OptionModel>& sm = models[s];
+	if (sm.size() < (size_t)numActions) sm.resize(numActions);
+	OptionModel& m = sm[actionIdx];
+	if (m.visits == 0) observed.push_back({s, actionIdx});
+	// running means: the model tracks the current policy's options, which change as it learns
+	++m.visits;
+	m.meanReward += (reward - m.meanReward) / m.visits;
+	m.meanSteps += (static_cast<float>(steps) - m.meanSteps) / m.visits;
+	m.meanDiscount += (discountFor(steps) - m.meanDiscount) / m.visits;
+	for (Outcome& o : m.outcomes) {
+		if (o.next == next) {
+			++o.count;
+			return;
+		}
+	}
+	m.outcomes.push_back({next, 1});
+}
+
+void OptionPlanner::samplePlanning(int n, std::vector<PendingBackup>& batch) {
+	if (observed.empty()) return;
+	const int last = static_cast<int>(observed.size()) - 1;
+	for (int i = 0; i < n; ++i) {
+		const Sample& smp = observed[planRng.uniformInt(0, last)];
+		const OptionModel& m = models[smp.state][smp.option];
+		// successor drawn in proportion to how often it followed
+		int pick = planRng.uniformInt(0, m.visits - 1);
+		const Outcome* o = m.outcomes.data();
+		while (pick >= o->count) {
+			pick -= o->count;
+			++o;
+		}
+		batch.push_back({smp.state, smp.option, m.meanReward, o->next, m.meanDiscount, 1.f, -1, 0.f});
+	}
+	simulated += static_cast<std::size_t>(n);
+}
+
+bool OptionPlanner::modelStats(const StateKey& state, int optionIdx, ModelStats& out) const {
+	const std::vector<OptionModel>& sm = models[stateId(state)];
+	if (optionIdx < 0 || (size_t)optionIdx >= sm.size()) return false;
+	const OptionModel& m = sm[optionIdx];
+	if (m.visits == 0) return false;
+	out.visits = m.visits;
+	out.meanReward = m.meanReward;
+	out.meanSteps = m.meanSteps;
+	out.meanDiscount = m.meanDiscount;
+	out.outcomes = m.outcomes.size();
+	return true;
+}
+
+void OptionPlanner::syncQTable() {
+	if (shared) shared->snapshot(qTable);
+}
+
+const QTable& OptionPlanner::exportTable(QTable& scratch) const {
+	if (!shared) return qTable;
+	shared->snapshot(scratch);
+	return scratch;
 }
 
 bool OptionPlanner::saveQTable(const std::string& path) const {
 	std::ofstream out(path);
 	if (!out.is_open()) {
-		std::cerr << "Failed to open Q-table file for writing: " << path << std::endl;
+		O3F_LOG_ERROR("Failed to open Q-table file for writing: " << path);
 		return false;
 	}
+	QTable scratch;
+	const QTable& table = exportTable(scratch);
 	// write rows as: state,q0,q1,...
 	out << std::fixed << std::setprecision(6);
-	for (const auto& kv : qTable) {
-		out << kv.first;
-		for (float q : kv.second) {
-			out << "," << q;
+	for (int s = 0; s < table.numStates(); ++s) {
+		if (!table.touched(s)) continue;
+		out << stateName(s);
+		const float* q = table.row(s);
+		for (int a = 0; a < table.numActions(); ++a) {
+			out << "," << q[a];
 		}
 		out << "\n";
 	}
@@ -112,16 +306,24 @@ bool OptionPlanner::saveQTable(const std::string& path) const {
 bool OptionPlanner::loadQTable(const std::string& path) {
 	std::ifstream in(path);
 	if (!in.is_open()) {
-		std::cerr << "Failed to open Q-table file for reading: " << path << std::endl;
+		O3F_LOG_ERROR("Failed to open Q-table file for reading: " << path);
 		return false;
 	}
-	qTable.clear();
+	qTable.reset(kNumStates, qTable.numActions());
+	// the model was learned against the old values
+	for (auto& sm : models) sm.clear();
+	observed.clear();
 	std::string line;
 	while (std::getline(in, line)) {
 		if (line.empty()) continue;
 		std::istringstream ss(line);
 		std::string state;
 		if (!std::getline(ss, state, ',')) continue;
+		int id;
+		if (!parseStateName(state, id)) {
+			O3F_LOG_WARN("Skipping Q-table row with unknown state '" << state << "'");
+			continue;
+		}
 		std::vector<float> qs;
 		std::string token;
 		while (std::getline(ss, token, ',')) {
@@ -132,9 +334,44 @@ bool OptionPlanner::loadQTable(const std::string& path) {
 				// skip invalid token
 			}
 		}
-		if (!qs.empty()) qTable[state] = qs;
+		if (qs.empty()) continue;
+		qTable.ensureActions(static_cast<int>(qs.size()));
+		std::copy(qs.begin(), qs.end(), qTable.row(id));
+		qTable.touch(id);
 	}
 	in.close();
+	if (shared) shared->load(qTable);
+	return true;
+}
+
+bool OptionPlanner::saveCheckpoint(const std::string& path) const {
+	QTable scratch;
+	if (!writeQCheckpoint(path, exportTable(scratch), kStateEncodingVersion)) {
+		O3F_LOG_ERROR("Failed to write Q-table checkpoint: " << path);
+		return false;
+	}
 	return true;
 }
 
+bool OptionPlanner::loadCheckpoint(const std::string& path) {
+	QCheckpointView view;
+	if (!view.open(path)) {
+		O3F_LOG_ERROR("Not a readable Q-table checkpoint: " << path);
+		return false;
+	}
+	if (!view.verify()) {
+		O3F_LOG_ERROR("Q-table checkpoint checksum mismatch: " << path);
+		return false;
+	}
+	if (view.stateEncoding() != kStateEncodingVersion || view.numStates() != kNumStates) {
+		O3F_LOG_ERROR("Q-table checkpoint " << path << " uses state encoding " << view.stateEncoding()
+			<< " with " << view.numStates() << " states; expected " << kStateEncodingVersion << " with " << kNumStates);
+		return false;
+	}
+	view.copyTo(qTable);
+	if (shared) shared->load(qTable);
+	// the model was learned against the old values
+	for (auto& sm : models) sm.clear();
+	observed.clear();
+	return true;
+}
@@ -0,0 +1,157 @@
+#include "QCheckpoint.hpp"
+#include "QTable.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+std::uint64_t checkpointChecksum(const std::uint8_t* data, std::size_t bytes) {
+	std::uint64_t h = 0xcbf29ce484222325ull;
+	for (std::size_t i = 0; i + 8 <= bytes; i += 8) {
+		std::uint64_t word;
+		std::memcpy(&word, data + i, sizeof(word));
+		h = (h ^ word) * 0x100000001b3ull;
+	}
+	return h;
+}
+
+#ifdef _WIN32
+
+static bool writeDurably(const std::string& path, const CheckpointHeader& hdr, const std::vector<std::uint8_t>& payload) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	auto writeAll = [file](const void* data, std::size_t bytes) {
+		const char* p = static_cast<const char*>(data);
+		while (bytes > 0) {
+			DWORD chunk = bytes > 0x40000000 ? 0x40000000 : static_cast<DWORD>(bytes);
+			DWORD written = 0;
+			if (!WriteFile(file, p, chunk, &written, nullptr) || written == 0) return false;
+			p += written;
+			bytes -= written;
+		}
+		return true;
+	};
+	const bool ok = writeAll(&hdr, sizeof(hdr)) && writeAll(payload.data(), payload.size()) && FlushFileBuffers(file);
+	CloseHandle(file);
+	return ok;
+}
+
+#else
+
+static bool writeDurably(const std::string& path, const CheckpointHeader& hdr, const std::vector<std::uint8_t>& payload) {
+	const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return false;
+	auto writeAll = [fd](const void* data, std::size_t bytes) {
+		const char* p = static_cast<const char*>(data);
+		while (bytes > 0) {
+			const ssize_t written = ::write(fd, p, bytes);
+			if (written < 0 && errno == EINTR) continue;
+			if (written <= 0) return false;
+			p += written;
+			bytes -= static_cast<std::size_t>(written);
+		}
+		return true;
+	};
+	bool ok = writeAll(&hdr, sizeof(hdr)) && writeAll(payload.data(), payload.size()) && ::fsync(fd) == 0;
+	if (::close(fd) != 0) ok = false;
+	return ok;
+}
+
+// Best effort: some filesystems refuse fsync on a directory
+static void syncParentDirectory(const std::string& path) {
+	const std::size_t slash = path.find_last_of('/');
+	const std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+	const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+	if (fd < 0) return;
+	::fsync(fd);
+	::close(fd);
+}
+
+#endif
+
+bool writeQCheckpoint(const std::string& path, const QTable& table, std::uint32_t stateEncoding) {
+	const std::uint32_t states = static_cast<std::uint32_t>(table.numStates());
+	const std::uint32_t actions = static_cast<std::uint32_t>(table.numActions());
+	std::vector<std::uint8_t> payload(checkpointPayloadBytes(states, actions), 0);
+	const std::size_t valueBytes = static_cast<std::size_t>(states) * actions * sizeof(float);
+	if (valueBytes > 0) std::memcpy(payload.data(), table.row(0), valueBytes);
+	for (std::uint32_t s = 0; s < states; ++s) payload[valueBytes + s] = table.touched(static_cast<int>(s)) ? 1 : 0;
+
+	CheckpointHeader hdr{};
+	std::memcpy(hdr.magic, kCheckpointMagic, sizeof(kCheckpointMagic));
+	hdr.version = kCheckpointVersion;
+	hdr.stateEncoding = stateEncoding;
+	hdr.numStates = states;
+	hdr.numActions = actions;
+	hdr.payloadBytes = payload.size();
+	hdr.checksum = checkpointChecksum(payload.data(), payload.size());
+
+	// The temporary file reaches the disk before the rename, and on POSIX the
+	// rename itself is made durable by syncing the directory, so a crash leaves
+	// either the old checkpoint or the new one at `path`
+	const std::string tmp = path + ".tmp";
+	if (!writeDurably(tmp, hdr, payload)) {
+		std::remove(tmp.c_str());
+		return false;
+	}
+#ifdef _WIN32
+	if (!MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+		std::remove(tmp.c_str());
+		return false;
+	}
+#else
+	if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+		std::remove(tmp.c_str());
+		return false;
+	}
+	syncParentDirectory(path);
+#endif
+	return true;
+}
+
+bool QCheckpointView::open(const std::string& path) {
+	header = nullptr;
+	values = nullptr;
+	touchedRows = nullptr;
+	if (!file.open(path)) return false;
+	if (file.size() < sizeof(CheckpointHeader)) {
+		file.close();
+		return false;
+	}
+	const auto* hdr = reinterpret_cast<const CheckpointHeader*>(file.data());
+	const bool valid = std::memcmp(hdr->magic, kCheckpointMagic, sizeof(kCheckpointMagic)) == 0 &&
+		hdr->version == kCheckpointVersion &&
+		hdr->payloadBytes == checkpointPayloadBytes(hdr->numStates, hdr->numActions) &&
+		hdr->payloadBytes <= file.size() - sizeof(CheckpointHeader);
+	if (!valid) {
+		file.close();
+		return false;
+	}
+	header = hdr;
+	values = reinterpret_cast<const float*>(file.data() + sizeof(CheckpointHeader));
+	touchedRows = file.data() + sizeof(CheckpointHeader) + static_cast<std::size_t>(hdr->numStates) * hdr->numActions * sizeof(float);
+	return true;
+}
+
+bool QCheckpointView::verify() const {
+	if (!header) return false;
+	return checkpointChecksum(file.data() + sizeof(CheckpointHeader), static_cast<std::size_t>(header->payloadBytes)) == header->checksum;
+}
+
+void QCheckpointView::copyTo(QTable& table) const {
+	table.reset(numStates(), numActions());
+	for (int s = 0; s < numStates(); ++s) {
+		std::memcpy(table.row(s), row(s), static_cast<std::size_t>(numActions()) * sizeof(float));
+		if (touched(s)) table.touch(s);
+	}
+}
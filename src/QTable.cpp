@@ -0,0 +1,40 @@
+#include "QTable.hpp"
+
+QTable::Storage QTable::allocate(int numStates, int numActions, std::size_t& floats) {
+	const std::size_t perLine = kAlign / sizeof(float);
+	floats = (static_cast<std::size_t>(numStates) * numActions + perLine - 1) / perLine * perLine;
+	if (floats == 0) return Storage();
+	Storage block(static_cast<float*>(::operator new(floats * sizeof(float), std::align_val_t{kAlign})));
+	std::fill_n(block.get(), floats, 0.0f);
+	return block;
+}
+
+QTable& QTable::operator=(const QTable& other) {
+	if (this == &other) return *this;
+	storage = allocate(other.states, other.actions, allocated);
+	if (allocated > 0) std::copy_n(other.values(), allocated, values());
+	states = other.states;
+	actions = other.actions;
+	touchedRows = other.touchedRows;
+	return *this;
+}
+
+void QTable::reset(int numStates, int numActions) {
+	states = numStates < 0 ? 0 : numStates;
+	actions = numActions < 0 ? 0 : numActions;
+	storage = allocate(states, actions, allocated);
+	touchedRows.assign(static_cast<std::size_t>(states), 0);
+}
+
+void QTable::ensureActions(int numActions) {
+	if (numActions <= actions) return;
+	std::size_t widerFloats = 0;
+	Storage wider = allocate(states, numActions, widerFloats);
+	for (int s = 0; s < states; ++s) {
+		const float* src = row(s);
+		std::copy(src, src + actions, wider.get() + static_cast<std::size_t>(s) * numActions);
+	}
+	storage = std::move(wider);
+	allocated = widerFloats;
+	actions = numActions;
+}
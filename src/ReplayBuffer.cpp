@@ -0,0 +1,87 @@
+#include "ReplayBuffer.hpp"
+#include "Rng.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Keeps zero-error transitions sampleable
+constexpr float kPriorityEpsilon = 1e-3f;
+}
+
+ReplayBuffer::ReplayBuffer(int capacity, float priorityExponent)
+	: exponent(priorityExponent < 0.0f ? 0.0f : priorityExponent) {
+	const std::size_t n = static_cast<std::size_t>(capacity < 1 ? 1 : capacity);
+	states.resize(n);
+	options.resize(n);
+	rewards.resize(n);
+	durations.resize(n);
+	nexts.resize(n);
+	if (prioritized()) {
+		leaves = 1;
+		while (leaves < n) leaves <<= 1;
+		tree.assign(2 * leaves, 0.0);
+	}
+}
+
+void ReplayBuffer::clear() {
+	head = 0;
+	count = 0;
+	maxPriority = 1.0f;
+	std::fill(tree.begin(), tree.end(), 0.0);
+}
+
+void ReplayBuffer::push(int state, int option, float reward, int duration, int next) {
+	states[head] = state;
+	options[head] = option;
+	rewards[head] = reward;
+	durations[head] = duration;
+	nexts[head] = next;
+	if (prioritized()) setLeaf(head, maxPriority);
+	head = head + 1 == capacity() ? 0 : head + 1;
+	if (count < capacity()) ++count;
+}
+
+void ReplayBuffer::setLeaf(int slot, double priority) {
+	std::size_t i = leaves + static_cast<std::size_t>(slot);
+	tree[i] = priority;
+	for (i >>= 1; i >= 1; i >>= 1) tree[i] = tree[2 * i] + tree[2 * i + 1];
+}
+
+void ReplayBuffer::setPriority(int slot, float tdError) {
+	const float p = std::pow(std::fabs(tdError) + kPriorityEpsilon, exponent);
+	maxPriority = std::max(maxPriority, p);
+	setLeaf(slot, p);
+}
+
+double ReplayBuffer::probability(int slot) const {
+	if (count == 0) return 0.0;
+	if (!prioritized() || tree[1] <= 0.0) return 1.0 / count;
+	return tree[leaves + static_cast<std::size_t>(slot)] / tree[1];
+}
+
+void ReplayBuffer::sample(int n, PhiloxEngine& rng, std::vector<int>& slots) const {
+	slots.clear();
+	if (count == 0 || n <= 0) return;
+	if (!prioritized()) {
+		for (int i = 0; i < n; ++i) slots.push_back(rng.uniformInt(0, count - 1));
+		std::sort(slots.begin(), slots.end());
+		return;
+	}
+	// one draw per equal slice of the mass; slices are ordered, so are the leaves found
+	const double segment = tree[1] / n;
+	for (int i = 0; i < n; ++i) {
+		double u = (i + rng.uniformFloat()) * segment;
+		std::size_t node = 1;
+		while (node < leaves) {
+			if (u < tree[2 * node] || tree[2 * node + 1] <= 0.0) node = 2 * node;
+			else {
+				u -= tree[2 * node];
+				node = 2 * node + 1;
+			}
+		}
+		// float rounding at a slice edge can land on an empty leaf past the end
+		const int slot = std::min(static_cast<int>(node - leaves), count - 1);
+		slots.push_back(slot);
+	}
+}
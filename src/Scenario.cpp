@@ -0,0 +1,84 @@
+#include "Scenario.hpp"
+#include "Env.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+bool ScenarioCorpus::open(const std::string& path) {
+	header = nullptr;
+	records = nullptr;
+	recordBytes = 0;
+	if (!file.open(path)) return false;
+	if (file.size() < sizeof(ScenarioHeader)) {
+		file.close();
+		return false;
+	}
+	const auto* hdr = reinterpret_cast<const ScenarioHeader*>(file.data());
+	const bool valid = std::memcmp(hdr->magic, kScenarioMagic, sizeof(kScenarioMagic)) == 0 &&
+		hdr->version == kScenarioVersion && hdr->gridWidth > 0 && hdr->gridHeight > 0 &&
+		hdr->gridWidth <= 0xFFFF && hdr->gridHeight <= 0xFFFF &&
+		hdr->recordBytes == scenarioRecordBytes(static_cast<int>(hdr->gridWidth), static_cast<int>(hdr->gridHeight)) &&
+		hdr->count <= (file.size() - sizeof(ScenarioHeader)) / hdr->recordBytes;
+	if (!valid) {
+		file.close();
+		return false;
+	}
+	header = hdr;
+	records = file.data() + sizeof(ScenarioHeader);
+	recordBytes = hdr->recordBytes;
+	return true;
+}
+
+bool ScenarioWriter::open(const std::string& path, int gridWidth, int gridHeight) {
+	if (gridWidth <= 0 || gridHeight <= 0 || gridWidth > 0xFFFF || gridHeight > 0xFFFF) return false;
+	out.open(path, std::ios::binary | std::ios::trunc);
+	if (!out) return false;
+	w = gridWidth;
+	h = gridHeight;
+	written = 0;
+	buffer.assign(scenarioRecordBytes(w, h), '\0');
+	ScenarioHeader hdr{};
+	std::memcpy(hdr.magic, kScenarioMagic, sizeof(kScenarioMagic));
+	hdr.version = kScenarioVersion;
+	hdr.recordBytes = static_cast<std::uint32_t>(buffer.size());
+	hdr.gridWidth = static_cast<std::uint32_t>(w);
+	hdr.gridHeight = static_cast<std::uint32_t>(h);
+	hdr.count = 0;
+	out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+	return static_cast<bool>(out);
+}
+
+bool ScenarioWriter::append(const Environment2D& env) {
+	if (!out || env.getGridWidth() != w || env.getGridHeight() != h) return false;
+	// records hold one object
+	if (env.objectCount() != 1 || env.isCarrying()) return false;
+	std::fill(buffer.begin(), buffer.end(), '\0');
+	ScenarioRecord rec{};
+	rec.robotX = static_cast<std::uint16_t>(env.getRobotCell().x);
+	rec.robotY = static_cast<std::uint16_t>(env.getRobotCell().y);
+	rec.targetX = static_cast<std::uint16_t>(env.getTargetCell().x);
+	rec.targetY = static_cast<std::uint16_t>(env.getTargetCell().y);
+	rec.objectX = static_cast<std::uint16_t>(env.getObjectCell().x);
+	rec.objectY = static_cast<std::uint16_t>(env.getObjectCell().y);
+	std::memcpy(&buffer[0], &rec, sizeof(rec));
+	auto* bits = reinterpret_cast<std::uint8_t*>(&buffer[sizeof(rec)]);
+	const std::vector<CellType>& grid = env.getGrid();
+	for (std::size_t i = 0; i < grid.size(); ++i) {
+		if (grid[i] == CellType::Obstacle) bits[i >> 3] |= static_cast<std::uint8_t>(1u << (i & 7));
+	}
+	out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	if (!out) return false;
+	++written;
+	return true;
+}
+
+bool ScenarioWriter::close() {
+	if (!out.is_open()) return false;
+	out.seekp(offsetof(ScenarioHeader, count));
+	out.write(reinterpret_cast<const char*>(&written), sizeof(written));
+	bool ok = static_cast<bool>(out);
+	out.close();
+	return ok;
+}
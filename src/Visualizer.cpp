@@ -41,15 +41,36 @@ void Visualizer::drawText(const std::string& text, float x, float y, sf::Color c
 	window.draw(textObj);
 }
 
+void Visualizer::drawGrid(const Environment2D& env) {
+	const std::vector<CellType>& grid = env.getGrid();
+	const int gridW = env.getGridWidth();
+	const int gridH = env.getGridHeight();
+	const float cellSize = env.getCellSize();
+	sf::RectangleShape cellShape({cellSize - 1.f, cellSize - 1.f});
+	for (int y = 0; y < gridH; ++y) {
+		for (int x = 0; x < gridW; ++x) {
+			CellType t = grid[y * gridW + x];
+			sf::Color c(40, 40, 45);
+			if (t == CellType::Obstacle) c = sf::Color(120, 60, 60);
+			if (t == CellType::Target) c = sf::Color(60, 120, 60);
+			if (t == CellType::Object) c = sf::Color(200, 200, 80);
+			if (t == CellType::Robot) c = sf::Color(80, 160, 220);
+			cellShape.setFillColor(c);
+			cellShape.setPosition(x * cellSize, y * cellSize);
+			window.draw(cellShape);
+		}
+	}
+}
+
 void Visualizer::render(Environment2D& env) {
 	window.clear(sf::Color(25, 25, 30));
-	env.render(window);
+	drawGrid(env);
 	window.display();
 }
 
 void Visualizer::renderWithOverlay(Environment2D& env, int episode, float totalReward, float successRate) {
 	window.clear(sf::Color(25, 25, 30));
-	env.render(window);
+	drawGrid(env);
 	
 	// Draw text overlays
 	drawText("Episode: " + std::to_string(episode), 10, 10, sf::Color::White);
@@ -1,4 +1,3 @@
-#include <SFML/Graphics.hpp>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -6,30 +5,108 @@
 #include <algorithm>
 
 #include "Env.hpp"
-#include "Agent.hpp"
-#include "Visualizer.hpp"
 #include "Planner.hpp"
 #include "Executor.hpp"
 #include "Option.hpp"
+#include "Log.hpp"
+#include "Scenario.hpp"
+
+#ifdef O3F_WITH_VIZ
+#include "Visualizer.hpp"
+using TrainingVisualizer = Visualizer;
+#else
+#include "HeadlessVisualizer.hpp"
+using TrainingVisualizer = HeadlessVisualizer;
+#endif
 
 int main(int argc, char** argv) {
-	const unsigned int W = 960, H = 600;
+	EnvConfig envCfg;
 	std::string loadQPath;
+	std::string scenarioPath;
+	unsigned int numObjects = 1;
 	int saveQInterval = 0;
+	int planningSteps = 0;
+	int replayCapacity = 0;
+	int replayBatch = 32;
+	float replayPriority = 0.f;
+	unsigned long long seed = 0;
+	bool hasSeed = false;
 	for (int i = 1; i < argc; ++i) {
 		std::string a = argv[i];
 		if (a == "--load-q" && i + 1 < argc) {
 			loadQPath = argv[++i];
 		} else if (a == "--save-q-interval" && i + 1 < argc) {
 			saveQInterval = std::stoi(argv[++i]);
+		} else if (a == "--log-level" && i + 1 < argc) {
+			LogLevel level;
+			if (parseLogLevel(argv[++i], level)) Logger::instance().setLevel(level);
+			else std::cerr << "Unknown log level '" << argv[i] << "'" << std::endl;
+		} else if (a == "--seed" && i + 1 < argc) {
+			seed = std::stoull(argv[++i]);
+			hasSeed = true;
+		} else if (a == "--grid-width" && i + 1 < argc) {
+			envCfg.gridWidth = std::stoi(argv[++i]);
+		} else if (a == "--grid-height" && i + 1 < argc) {
+			envCfg.gridHeight = std::stoi(argv[++i]);
+		} else if (a == "--obstacle-density" && i + 1 < argc) {
+			envCfg.obstacleDensity = std::stof(argv[++i]);
+		} else if (a == "--cell-size" && i + 1 < argc) {
+			envCfg.cellSize = std::stof(argv[++i]);
+		} else if (a == "--objects" && i + 1 < argc) {
+			numObjects = static_cast<unsigned int>(std::stoul(argv[++i]));
+		} else if (a == "--scenarios" && i + 1 < argc) {
+			scenarioPath = argv[++i];
+		} else if (a == "--planning-steps" && i + 1 < argc) {
+			planningSteps = std::stoi(argv[++i]);
+		} else if (a == "--replay" && i + 1 < argc) {
+			replayCapacity = std::stoi(argv[++i]);
+		} else if (a == "--replay-batch" && i + 1 < argc) {
+			replayBatch = std::stoi(argv[++i]);
+		} else if (a == "--replay-priority" && i + 1 < argc) {
+			replayPriority = std::stof(argv[++i]);
 		}
 	}
 
-	Environment2D env(W, H);
-	env.setEpisodeNumber(0);
-	env.reset(5);
+	// A scenario corpus fixes the grid size; episode k replays scenario k (mod corpus size)
+	ScenarioCorpus corpus;
+	if (!scenarioPath.empty()) {
+		if (corpus.open(scenarioPath) && corpus.size() > 0) {
+			envCfg.gridWidth = corpus.gridWidth();
+			envCfg.gridHeight = corpus.gridHeight();
+			O3F_LOG_INFO("Loaded " << corpus.size() << " scenarios from " << scenarioPath);
+		} else {
+			O3F_LOG_WARN("Could not load scenario corpus '" << scenarioPath << "'; generating maps instead");
+			corpus = ScenarioCorpus();
+		}
+	}
 
-	Visualizer viz(W, H);
+	// Window/continuous space covers the grid, never smaller than the classic 960x600 layout
+	const unsigned int W = std::max(960u, static_cast<unsigned int>(std::max(envCfg.gridWidth, MIN_GRID_WIDTH) * envCfg.cellSize));
+	const unsigned int H = std::max(600u, static_cast<unsigned int>(std::max(envCfg.gridHeight, MIN_GRID_HEIGHT) * envCfg.cellSize));
+	Environment2D env(W, H, envCfg);
+	if (hasSeed) env.setSeed(seed);
+	if (corpus.isOpen() && !env.attachScenarios(&corpus)) {
+		O3F_LOG_WARN("Scenario grid " << corpus.gridWidth() << "x" << corpus.gridHeight() << " does not fit the environment; generating maps instead");
+	}
+	// Episode start: reset index 0 of episode ep, or scenario ep of the corpus
+	auto resetEpisode = [&](int ep) {
+		env.setEpisodeNumber(ep);
+		if (env.resetFromScenario(static_cast<std::size_t>(ep) % std::max<std::size_t>(corpus.size(), 1))) return;
+		env.reset(numObjects);
+	};
+	// Manual reset from the viewer: the next reset index of the same episode,
+	// so a generated map is new but still a pure function of (seed, episode,
+	// reset index). A corpus episode replays its own scenario.
+	auto resetAgain = [&](int ep) {
+		if (env.resetFromScenario(static_cast<std::size_t>(ep) % std::max<std::size_t>(corpus.size(), 1))) return;
+		env.reset(numObjects);
+	};
+	// Report the seed so any run can be replayed with --seed
+	O3F_LOG_INFO("Environment seed: " << env.getSeed());
+	O3F_LOG_INFO("Grid " << env.getGridWidth() << "x" << env.getGridHeight() << ", obstacle density " << env.getConfig().obstacleDensity);
+	resetEpisode(0);
+
+	TrainingVisualizer viz(W, H);
 	// configure planner with explicit hyperparameters so we can decay epsilon
 	PlannerConfig plannerCfg;
 	plannerCfg.alpha = 0.1f;
@@ -37,13 +114,22 @@ int main(int argc, char** argv) {
 	plannerCfg.epsilon = 1.0f;
 	plannerCfg.epsilonDecay = 0.995f;
 	plannerCfg.epsilonMin = 0.05f;
+	// Dyna-Q backups per executed option, drawn from the learned option model
+	plannerCfg.planningSteps = planningSteps;
+	plannerCfg.planningSeed = env.getSeed();
+	plannerCfg.replayCapacity = replayCapacity;
+	plannerCfg.replayBatch = replayBatch;
+	plannerCfg.replayPriority = replayPriority;
 	OptionPlanner planner(plannerCfg);
 
 	if (!loadQPath.empty()) {
-		if (planner.loadQTable(loadQPath)) {
-			std::cout << "Loaded Q-table from " << loadQPath << std::endl;
+		// binary checkpoints by extension, CSV otherwise
+		const std::string ext = ".o3fq";
+		const bool binary = loadQPath.size() >= ext.size() && loadQPath.compare(loadQPath.size() - ext.size(), ext.size(), ext) == 0;
+		if (binary ? planner.loadCheckpoint(loadQPath) : planner.loadQTable(loadQPath)) {
+			O3F_LOG_INFO("Loaded Q-table from " << loadQPath);
 		} else {
-			std::cout << "Failed to load Q-table from " << loadQPath << std::endl;
+			O3F_LOG_WARN("Failed to load Q-table from " << loadQPath);
 		}
 	}
 
@@ -56,26 +142,29 @@ int main(int argc, char** argv) {
 	if (csv.is_open()) {
 		csv << "episode,total_reward,success,steps,options_used,epsilon\n";
 	} else {
-		std::cout << "Warning: could not open training log file '" << filename << "' for writing." << std::endl;
+		O3F_LOG_WARN("Could not open training log file '" << filename << "' for writing.");
 	}
-	OptionExecutor executor;
-	auto options = makeDefaultOptions();
+	OptionExecutor executor(plannerCfg.gamma);
+	// One shared, immutable option set; each episode runs on a pooled context
+	const auto options = makeDefaultOptions();
+	OptionContextPool contexts;
 
 	int successfulEpisodes = 0;
 	const int MAX_EPISODES = 200;
 	float cumulativeReward = 0.f;
 
 	for (int episode = 0; episode < MAX_EPISODES && viz.isOpen(); ++episode) {
-	env.setEpisodeNumber(episode);
-	env.reset(5);
+		resetEpisode(episode);
+		OptionContext& ctx = contexts.acquire();
 		bool done = false;
 		float episodeReward = 0.f;
 		int optionCount = 0;
+		int episodeSteps = 0; // primitive steps over all options
 		const int MAX_OPTIONS_PER_EPISODE = 150; // allow up to 150 options - more time for complex navigation
 		
 		// state machine: 0=ClearObstacles, 1=MoveToTarget, 2=ReturnToObject, 3=MoveObjectToTarget
 		int currentPhase = 0;
-		const char* phaseNames[] = {"ClearObstacle", "MoveToTarget", "ReturnToObject", "MoveObjectToTarget"};
+		[[maybe_unused]] const char* phaseNames[] = {"ClearObstacle", "MoveToTarget", "ReturnToObject", "MoveObjectToTarget"};
 		
 		// track whether the robot has reached the target at least once this episode
 		bool reachedTargetOnce = false;
@@ -91,8 +180,7 @@ int main(int argc, char** argv) {
 			viz.pollEvents(shouldClose, resetRequested);
 			if (shouldClose) break;
 			if (resetRequested) {
-				env.setEpisodeNumber(episode);
-				env.reset(5);
+				resetAgain(episode);
 				currentPhase = 0;
 				phaseJustChanged = false;
 			}
@@ -100,8 +188,9 @@ int main(int argc, char** argv) {
 			// check phase transition conditions FIRST, before executing any option
 			phaseJustChanged = false;
 			if (currentPhase == 0) {
-				// ClearObstacles phase: transition when no obstacles nearby
-				if (!env.hasObstacleNeighbor()) {
+				// ClearObstacles phase: transition once the minimum clearing-cost path
+				// to the target no longer starts with an obstacle
+				if (!env.hasPlannedClear(env.getTargetCell())) {
 					currentPhase = 1;
 					phaseJustChanged = true;
 				}
@@ -110,14 +199,14 @@ int main(int argc, char** argv) {
 				if (env.getRobotCell() == env.getTargetCell()) {
 					currentPhase = 2;
 					phaseJustChanged = true;
-					std::cout << "Episode " << episode << " - Reached target! Transitioning to ReturnToObject phase." << std::endl;
+					O3F_LOG_DEBUG("Episode " << episode << " - Reached target! Transitioning to ReturnToObject phase.");
 				}
 			} else if (currentPhase == 2) {
 				// ReturnToObject phase: transition when carrying object
 				if (env.isCarrying()) {
 					currentPhase = 3;
 					phaseJustChanged = true;
-					std::cout << "Episode " << episode << " - Picked up object! Transitioning to MoveObjectToTarget phase." << std::endl;
+					O3F_LOG_DEBUG("Episode " << episode << " - Picked up object! Transitioning to MoveObjectToTarget phase.");
 				}
 			}
 
@@ -133,8 +222,8 @@ int main(int argc, char** argv) {
 			// Special handling for Phase 2 (ReturnToObject → MoveToObject):
 			// Phase 2 strategy: Clear obstacles first, then move toward object
 			else if (currentPhase == 2) {
-				if (!env.isCarrying() && env.hasObstacleNeighbor()) {
-					// Always clear adjacent obstacles in Phase 2
+				if (env.hasPlannedClear(env.getObjectCell())) {
+					// Clear the obstacle the planned path to the object runs into
 					option = 0;  // ClearObstacle
 				} else {
 					// No adjacent obstacles - move toward object using ReturnToObject
@@ -146,25 +235,27 @@ int main(int argc, char** argv) {
 				// If already at target, don't trigger obstacle clearing
 				if (env.getRobotCell() == env.getTargetCell()) {
 					option = 1;  // Stay with MoveToTarget to finish the step cleanly
-				} else if (!env.isCarrying() && env.hasObstacleNeighbor()) {
-					// If not at target and obstacles nearby, clear them
+				} else if (env.hasPlannedClear(env.getTargetCell())) {
+					// If not at target and the planned path is blocked, clear the way
 					option = 0;  // ClearObstacle option
 				} else {
 					// No obstacles - proceed with MoveToTarget
 					option = 1;
 				}
 			}
-			// For phase 0, clear obstacles opportunistically when not carrying
-			else if (currentPhase == 0 && !env.isCarrying() && env.hasObstacleNeighbor()) {
+			// For phase 0, clear obstacles on the planned path when not carrying
+			else if (currentPhase == 0 && env.hasPlannedClear(env.getTargetCell())) {
 				option = 0; // ClearObstacle option
 			}
 			
 			// Store previous state for Q-learning
-			Environment2D prevState = env;
+			StateKey prevState = env.stateKey();
 			
-			options[option]->onSelect(env);
-			float reward = executor.executeOption(env, *options[option], 5, currentPhase);
-			planner.updateQ(prevState, option, reward, env, (int)options.size());
+			options[option]->onSelect(env, ctx);
+			const OptionResult result = executor.executeOption(env, *options[option], ctx, 5, currentPhase);
+			float reward = result.reward;
+			planner.updateQ(prevState, option, result.discountedReward, env.stateKey(), (int)options.size(), result.steps);
+			episodeSteps += result.steps;
 			episodeReward += reward;
 			cumulativeReward += reward;
 
@@ -172,50 +263,44 @@ int main(int argc, char** argv) {
 			// reached the target earlier in this episode, drop it one cell to the left so the
 			// robot can continue searching/clearing. If we've already reached the target once,
 			// allow the pickup to stand.
-			if (!prevState.isCarrying() && env.isCarrying() && currentPhase != 3 && !reachedTargetOnce) {
+			if (!prevState.carrying && env.isCarrying() && currentPhase != 3 && !reachedTargetOnce) {
 				if (env.dropObjectLeft()) {
-					std::cout << "Episode " << episode << ": picked up object prematurely - dropped to left to allow searching for target." << std::endl;
+					O3F_LOG_DEBUG("Episode " << episode << ": picked up object prematurely - dropped to left to allow searching for target.");
 				} else {
-					std::cout << "Episode " << episode << ": attempted to drop object but no valid drop cell found; still carrying." << std::endl;
+					O3F_LOG_DEBUG("Episode " << episode << ": attempted to drop object but no valid drop cell found; still carrying.");
 				}
 			}
 			
 			// Debug: print reward info
 			if (episode < 3) { // Only print first 3 episodes
-				std::cout << "Episode " << episode << ", Phase: " << phaseNames[currentPhase] 
+				O3F_LOG_DEBUG("Episode " << episode << ", Phase: " << phaseNames[currentPhase]
 				          << " (Option: " << phaseNames[option] << ")"
-				          << ", Reward: " << reward << ", Total: " << episodeReward 
-				          << ", Robot at (" << env.getRobotCell().x << "," << env.getRobotCell().y << ")";
-				if (currentPhase == 3) {
-					std::cout << " [Following stored path]";
-				}
-				std::cout << std::endl;
+				          << ", Reward: " << reward << ", Total: " << episodeReward
+				          << ", Robot at (" << env.getRobotCell().x << "," << env.getRobotCell().y << ")"
+				          << (currentPhase == 3 ? " [Following stored path]" : ""));
 			}
 			
 			// Check again after execution if phase should transition
 			if (currentPhase == 0) {
-				if (!env.hasObstacleNeighbor()) {
+				if (!env.hasPlannedClear(env.getTargetCell())) {
 					currentPhase = 1;
 				}
 			} else if (currentPhase == 1) {
 				if (env.getRobotCell() == env.getTargetCell()) {
 					currentPhase = 2;
 					reachedTargetOnce = true; // mark that we've reached the target at least once this episode
-					std::cout << "Episode " << episode << " - Reached target! Transitioning to ReturnToObject phase." << std::endl;
+					O3F_LOG_DEBUG("Episode " << episode << " - Reached target! Transitioning to ReturnToObject phase.");
 				}
 			} else if (currentPhase == 2) {
 				if (env.isCarrying()) {
 					currentPhase = 3;
-					std::cout << "Episode " << episode << " - Picked up object! Transitioning to MoveObjectToTarget phase." << std::endl;
+					O3F_LOG_DEBUG("Episode " << episode << " - Picked up object! Transitioning to MoveObjectToTarget phase.");
 					
-					// Pass the path taken to reach the object to MoveObjectToTargetOption
-					MoveToObjectOption* moveToObjOpt = dynamic_cast<MoveToObjectOption*>(options[2].get());
-					MoveObjectToTargetOption* moveObjToTargetOpt = dynamic_cast<MoveObjectToTargetOption*>(options[3].get());
-					if (moveToObjOpt && moveObjToTargetOpt) {
-						auto path = moveToObjOpt->getPathToObject();
-						std::cout << "  Path size: " << path.size() << " waypoints" << std::endl;
-						moveObjToTargetOpt->setReturnPath(path);
-						std::cout << "  Path set for return journey" << std::endl;
+					// Pass the path MoveToObject recorded (if it ran) to MoveObjectToTarget
+					if (!ctx.pathToObject.empty()) {
+						O3F_LOG_DEBUG("  Path size: " << ctx.pathToObject.size() << " waypoints");
+						ctx.setReturnPath(ctx.pathToObject);
+						O3F_LOG_DEBUG("  Path set for return journey");
 					}
 				}
 			} else if (currentPhase == 3) {
@@ -226,7 +311,7 @@ int main(int argc, char** argv) {
 					successfulEpisodes++;
 					reward += 50.0f; // Big reward for success
 					episodeReward += 50.0f;
-					std::cout << "Episode " << episode << " SUCCESS! Reward: " << episodeReward << std::endl;
+					O3F_LOG_INFO("Episode " << episode << " SUCCESS! Reward: " << episodeReward);
 				}
 			}
 			
@@ -247,7 +332,7 @@ int main(int argc, char** argv) {
 			// Increased from 15 to 40 to allow extended obstacle clearing and navigation
 			if (stepsWithoutProgress > 40) {
 				episodeReward -= 20.0f; // Penalty for getting stuck
-				std::cout << "Episode " << episode << " terminated early - stuck without progress" << std::endl;
+				O3F_LOG_INFO("Episode " << episode << " terminated early - stuck without progress");
 				break;
 			}
 		} else {
@@ -258,17 +343,18 @@ int main(int argc, char** argv) {
 			optionCount++;
 			viz.delay(50); // Reduced delay for faster decisions
 		}
+		contexts.release(ctx);
 		
 		// Print episode summary
 		if (episode % 10 == 0) {
-			std::cout << "Episode " << episode << " complete. Reward: " << episodeReward 
-					  << ", Success rate: " << (float)successfulEpisodes / (episode + 1) * 100 << "%" << std::endl;
+			O3F_LOG_INFO("Episode " << episode << " complete. Reward: " << episodeReward
+					  << ", Success rate: " << (float)successfulEpisodes / (episode + 1) * 100 << "%");
 		}
 
-		// Log episode to CSV (approximate steps as options_used * maxStepsPerOption(=5) here)
+		// Log episode to CSV
 		bool success = env.isTaskComplete();
 		int optionsUsed = optionCount;
-		int stepsTaken = optionsUsed * 5; // maxStepsPerOption is now 5
+		int stepsTaken = episodeSteps;
 		if (csv.is_open()) {
 			csv << episode << "," 
 				<< std::fixed << std::setprecision(4) << episodeReward << "," 
@@ -289,11 +375,11 @@ int main(int argc, char** argv) {
 			std::tm* lt = std::localtime(&now2);
 			char ts[64];
 			std::strftime(ts, sizeof(ts), "%Y%m%d_%H%M", lt);
-			std::string qfilename = std::string("qtable_") + ts + "_ep" + std::to_string(episode) + ".csv";
-			if (planner.saveQTable(qfilename)) {
-				std::cout << "Saved Q-table to " << qfilename << std::endl;
+			std::string qfilename = std::string("qtable_") + ts + "_ep" + std::to_string(episode) + ".o3fq";
+			if (planner.saveCheckpoint(qfilename)) {
+				O3F_LOG_INFO("Saved Q-table to " << qfilename);
 			} else {
-				std::cout << "Failed to save Q-table to " << qfilename << std::endl;
+				O3F_LOG_WARN("Failed to save Q-table to " << qfilename);
 			}
 		}
 	}
@@ -305,13 +391,26 @@ int main(int argc, char** argv) {
 		char ts3[64];
 		std::strftime(ts3, sizeof(ts3), "%Y%m%d_%H%M", lt3);
 		std::string finalQ = std::string("qtable_final_") + ts3 + ".csv";
-		if (planner.saveQTable(finalQ)) std::cout << "Saved final Q-table to " << finalQ << std::endl;
-		else std::cout << "Failed to save final Q-table to " << finalQ << std::endl;
+		if (planner.saveQTable(finalQ)) O3F_LOG_INFO("Saved final Q-table to " << finalQ);
+		else O3F_LOG_WARN("Failed to save final Q-table to " << finalQ);
+		// plus a binary checkpoint to resume or serve from
+		std::string finalCheckpoint = std::string("qtable_final_") + ts3 + ".o3fq";
+		if (planner.saveCheckpoint(finalCheckpoint)) O3F_LOG_INFO("Saved final checkpoint to " << finalCheckpoint);
+		else O3F_LOG_WARN("Failed to save final checkpoint to " << finalCheckpoint);
 	}
 
-	std::cout << "\nTraining complete!" << std::endl;
-	std::cout << "Total successful episodes: " << successfulEpisodes << " / " << MAX_EPISODES << std::endl;
-	std::cout << "Success rate: " << (float)successfulEpisodes / MAX_EPISODES * 100 << "%" << std::endl;
+	O3F_LOG_INFO("Training complete!");
+	O3F_LOG_INFO("Total successful episodes: " << successfulEpisodes << " / " << MAX_EPISODES);
+	O3F_LOG_INFO("Success rate: " << (float)successfulEpisodes / MAX_EPISODES * 100 << "%");
+	if (planningSteps > 0) {
+		O3F_LOG_INFO("Option model: " << planner.modelSize() << " (state, option) pairs, "
+			<< planner.planningBackups() << " simulated backups");
+	}
+	if (replayCapacity > 0) {
+		O3F_LOG_INFO("Replay: " << planner.replaySize() << " stored transitions, "
+			<< planner.replayBackups() << " replayed backups");
+	}
+	Logger::instance().flush();
 	
 	return 0;
 }
\ No newline at end of file
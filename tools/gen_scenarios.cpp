@@ -0,0 +1,61 @@
+// Writes a binary scenario corpus (see include/Scenario.hpp). Scenario k is the
+// map Environment2D::reset() generates for episode k under --seed, so a corpus
+// replays exactly the maps a seeded training run would have seen.
+//
+// Usage: o3f_gen_scenarios --out <file> [--count N] [--seed N] [--grid-width W]
+//                          [--grid-height H] [--obstacle-density D]
+
+#include <iostream>
+#include <string>
+
+#include "Env.hpp"
+#include "Scenario.hpp"
+
+int main(int argc, char** argv) {
+	EnvConfig cfg;
+	std::string outPath;
+	unsigned long long count = 1000;
+	unsigned long long seed = 1;
+	for (int i = 1; i < argc; ++i) {
+		std::string a = argv[i];
+		if (a == "--out" && i + 1 < argc) outPath = argv[++i];
+		else if (a == "--count" && i + 1 < argc) count = std::stoull(argv[++i]);
+		else if (a == "--seed" && i + 1 < argc) seed = std::stoull(argv[++i]);
+		else if (a == "--grid-width" && i + 1 < argc) cfg.gridWidth = std::stoi(argv[++i]);
+		else if (a == "--grid-height" && i + 1 < argc) cfg.gridHeight = std::stoi(argv[++i]);
+		else if (a == "--obstacle-density" && i + 1 < argc) cfg.obstacleDensity = std::stof(argv[++i]);
+		else {
+			outPath.clear();
+			break;
+		}
+	}
+	if (outPath.empty()) {
+		std::cerr << "usage: o3f_gen_scenarios --out <file> [--count N] [--seed N] [--grid-width W] [--grid-height H] [--obstacle-density D]" << std::endl;
+		return 1;
+	}
+
+	Environment2D env(static_cast<unsigned int>(cfg.gridWidth * cfg.cellSize),
+		static_cast<unsigned int>(cfg.gridHeight * cfg.cellSize), cfg);
+	env.setSeed(seed);
+
+	ScenarioWriter writer;
+	if (!writer.open(outPath, env.getGridWidth(), env.getGridHeight())) {
+		std::cerr << "Could not open '" << outPath << "' for writing" << std::endl;
+		return 1;
+	}
+	for (unsigned long long k = 0; k < count; ++k) {
+		env.setEpisodeNumber(static_cast<int>(k));
+		env.reset(1);
+		if (!writer.append(env)) {
+			std::cerr << "Write failed after " << writer.count() << " scenarios" << std::endl;
+			return 1;
+		}
+	}
+	if (!writer.close()) {
+		std::cerr << "Could not finalize '" << outPath << "'" << std::endl;
+		return 1;
+	}
+	std::cout << "Wrote " << writer.count() << " " << env.getGridWidth() << "x" << env.getGridHeight()
+		<< " scenarios to " << outPath << std::endl;
+	return 0;
+}